@@ -0,0 +1,119 @@
+//  arena.c : partie implantation du module arena.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+//  ARENA__MIN_BLOCK_SIZE, ARENA__MAX_BLOCK_SIZE : tailles du premier bloc
+//    ordinaire d'une arène et taille au-delà de laquelle celle des blocs
+//    ordinaires suivants, doublée à chaque nouveau bloc, cesse de croître.
+#define ARENA__MIN_BLOCK_SIZE ((size_t) 1 << 16)
+#define ARENA__MAX_BLOCK_SIZE ((size_t) 1 << 22)
+
+//  arena__block : bloc de size octets de données data, chaîné au bloc alloué
+//    avant lui par next.
+typedef struct arena__block arena__block;
+
+struct arena__block {
+  arena__block *next;
+  size_t size;
+  char data[];
+};
+
+//  struct arena, arena : head repère la liste des blocs, le bloc ordinaire
+//    courant en tête. Les avail octets libres du bloc courant débutent à
+//    l'adresse cursor. block_size est la taille du prochain bloc ordinaire.
+struct arena {
+  arena__block *head;
+  char *cursor;
+  size_t avail;
+  size_t block_size;
+};
+
+arena *arena_empty(void) {
+  arena *ar = malloc(sizeof *ar);
+  if (ar == nullptr) {
+    return nullptr;
+  }
+  ar->head = nullptr;
+  ar->cursor = nullptr;
+  ar->avail = 0;
+  ar->block_size = ARENA__MIN_BLOCK_SIZE;
+  return ar;
+}
+
+void arena_dispose(arena **arptr) {
+  if (*arptr == nullptr) {
+    return;
+  }
+  arena__block *b = (*arptr)->head;
+  while (b != nullptr) {
+    arena__block *t = b;
+    b = b->next;
+    free(t);
+  }
+  free(*arptr);
+  *arptr = nullptr;
+}
+
+//  arena__alloc : renvoie l'adresse de n octets libres de l'arène associée à
+//    ar, n > 0, ou un pointeur nul en cas de dépassement de capacité. Une zone
+//    de plus du quart de la taille des blocs ordinaires occupe un bloc propre,
+//    inséré derrière le bloc courant pour ne pas en perdre la place libre.
+static char *arena__alloc(arena *ar, size_t n) {
+  if (n <= ar->avail) {
+    char *p = ar->cursor;
+    ar->cursor += n;
+    ar->avail -= n;
+    return p;
+  }
+  if (n > SIZE_MAX - sizeof(arena__block)) {
+    return nullptr;
+  }
+  if (n > ar->block_size / 4) {
+    arena__block *b = malloc(sizeof(arena__block) + n);
+    if (b == nullptr) {
+      return nullptr;
+    }
+    b->size = n;
+    if (ar->head == nullptr) {
+      b->next = nullptr;
+      ar->head = b;
+    } else {
+      b->next = ar->head->next;
+      ar->head->next = b;
+    }
+    return b->data;
+  }
+  arena__block *b = malloc(sizeof(arena__block) + ar->block_size);
+  if (b == nullptr) {
+    return nullptr;
+  }
+  b->size = ar->block_size;
+  b->next = ar->head;
+  ar->head = b;
+  ar->cursor = b->data + n;
+  ar->avail = b->size - n;
+  if (ar->block_size < ARENA__MAX_BLOCK_SIZE) {
+    ar->block_size *= 2;
+  }
+  return b->data;
+}
+
+char *arena_strndup(arena *ar, const char *s, size_t n) {
+  if (n == SIZE_MAX) {
+    return nullptr;
+  }
+  char *p = arena__alloc(ar, n + 1);
+  if (p == nullptr) {
+    return nullptr;
+  }
+  memcpy(p, s, n);
+  p[n] = '\0';
+  return p;
+}
+
+char *arena_strdup(arena *ar, const char *s) {
+  return arena_strndup(ar, s, strlen(s));
+}
@@ -0,0 +1,41 @@
+//  arena.h : partie interface d'un module d'allocation de chaînes de
+//    caractères par blocs.
+//  Fonctionnement général :
+//  - les chaînes sont recopiées les unes à la suite des autres dans de grands
+//    blocs, par simple avancée d'un pointeur ; une chaîne trop longue pour
+//    tenir dans un bloc ordinaire dispose de son propre bloc ;
+//  - les chaînes ne peuvent être libérées individuellement : elles le sont
+//    toutes à la fois, avec l'arène.
+
+#ifndef ARENA__H
+#define ARENA__H
+
+#include <stddef.h>
+
+//  struct arena, arena : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une arène.
+typedef struct arena arena;
+
+//  arena_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle arène initialement vide. Renvoie un pointeur nul en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé à l'arène.
+extern arena *arena_empty(void);
+
+//  arena_dispose : sans effet si *arptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de l'arène associée à *arptr, y
+//    compris toutes les chaînes qui y ont été recopiées, puis affecte un
+//    pointeur nul à *arptr.
+extern void arena_dispose(arena **arptr);
+
+//  arena_strndup : tente de recopier dans l'arène associée à ar les n
+//    premiers octets de la zone pointée par s, suivis d'un caractère nul.
+//    Renvoie un pointeur nul en cas de dépassement de capacité. Renvoie sinon
+//    l'adresse de la copie, valide jusqu'à la libération de l'arène.
+extern char *arena_strndup(arena *ar, const char *s, size_t n);
+
+//  arena_strdup : comme arena_strndup, la chaîne pointée par s étant
+//    recopiée en entier.
+extern char *arena_strdup(arena *ar, const char *s);
+
+#endif
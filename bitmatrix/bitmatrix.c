@@ -0,0 +1,210 @@
+//  bitmatrix.c : partie implantation du module bitmatrix.
+
+#include <stdlib.h>
+#include <string.h>
+#include "bitmatrix.h"
+
+#if defined __GNUC__ && defined __x86_64__
+#define BITMATRIX__X86
+#include <immintrin.h>
+#endif
+
+//  struct bitmatrix, bitmatrix : les lignes sont rangées consécutivement dans
+//    le tableau bits, aligné sur BITMATRIX__ALIGN octets. Chaque ligne occupe
+//    stride mots de 64 bits, stride étant un multiple de BITMATRIX__LANES de
+//    sorte que les noyaux vectoriels n'aient à traiter aucune fin de ligne
+//    partielle. nrows est le nombre de lignes. and_count est le noyau de
+//    comptage retenu pour le processeur courant lors de la construction.
+struct bitmatrix {
+  uint64_t *bits;
+  size_t stride;
+  size_t nrows;
+  size_t (*and_count)(const uint64_t *, const uint64_t *, size_t);
+};
+
+#define BITMATRIX__ALIGN 64
+#define BITMATRIX__LANES (BITMATRIX__ALIGN / sizeof(uint64_t))
+
+//  BITMATRIX__TILE_ROWS, BITMATRIX__TILE_WORDS : nombre de lignes d'un bloc de
+//    colonnes de la matrice des intersections et nombre de mots de 64 bits
+//    d'une tranche de lignes. Les tranches des lignes d'un bloc et celles des
+//    lignes [i0, i1[ doivent tenir ensemble dans le cache de second niveau.
+#define BITMATRIX__TILE_ROWS 32
+#define BITMATRIX__TILE_WORDS 1024
+
+//  BITMATRIX__STRIDE : nombre de mots de 64 bits d'une ligne de ncols
+//    colonnes.
+#define BITMATRIX__STRIDE(ncols)                                               \
+  (((ncols) + 64 * BITMATRIX__LANES - 1) / (64 * BITMATRIX__LANES)             \
+  * BITMATRIX__LANES)
+
+static size_t (*bitmatrix__kernel(void))(const uint64_t *, const uint64_t *,
+    size_t);
+
+size_t bitmatrix_size(size_t nrows, size_t ncols) {
+  size_t stride = BITMATRIX__STRIDE(ncols);
+  if (nrows != 0 && stride > SIZE_MAX / sizeof(uint64_t) / nrows) {
+    return SIZE_MAX;
+  }
+  return nrows * stride * sizeof(uint64_t);
+}
+
+bitmatrix *bitmatrix_build(wordset **sets, size_t nrows, size_t ncols) {
+  size_t size = bitmatrix_size(nrows, ncols);
+  if (size == SIZE_MAX) {
+    return nullptr;
+  }
+  bitmatrix *bm = malloc(sizeof *bm);
+  if (bm == nullptr) {
+    return nullptr;
+  }
+  bm->bits = aligned_alloc(BITMATRIX__ALIGN, size == 0 ? BITMATRIX__ALIGN
+      : size);
+  if (bm->bits == nullptr) {
+    free(bm);
+    return nullptr;
+  }
+  memset(bm->bits, 0, size);
+  bm->stride = BITMATRIX__STRIDE(ncols);
+  bm->nrows = nrows;
+  bm->and_count = bitmatrix__kernel();
+  for (size_t i = 0; i < nrows; ++i) {
+    if (sets[i] == nullptr) {
+      continue;
+    }
+    uint64_t *row = bm->bits + i * bm->stride;
+    const uint32_t *ids = wordset_ids(sets[i]);
+    for (size_t k = 0; k < wordset_count(sets[i]); ++k) {
+      row[ids[k] / 64] |= (uint64_t) 1 << (ids[k] % 64);
+    }
+  }
+  return bm;
+}
+
+void bitmatrix_dispose(bitmatrix **bmptr) {
+  if (*bmptr == nullptr) {
+    return;
+  }
+  free((*bmptr)->bits);
+  free(*bmptr);
+  *bmptr = nullptr;
+}
+
+//  bitmatrix__and_count_portable : renvoie le nombre de bits à 1 du « et » bit
+//    à bit des tableaux a et b de n mots de 64 bits.
+static size_t bitmatrix__and_count_portable(const uint64_t *a,
+    const uint64_t *b, size_t n) {
+  size_t c = 0;
+  for (size_t k = 0; k < n; ++k) {
+    c += (size_t) __builtin_popcountll(a[k] & b[k]);
+  }
+  return c;
+}
+
+#if defined BITMATRIX__X86
+
+//  bitmatrix__and_count_popcnt : comme bitmatrix__and_count_portable, compilée
+//    pour l'instruction POPCNT.
+__attribute__((target("popcnt")))
+static size_t bitmatrix__and_count_popcnt(const uint64_t *a,
+    const uint64_t *b, size_t n) {
+  size_t c = 0;
+  for (size_t k = 0; k < n; ++k) {
+    c += (size_t) __builtin_popcountll(a[k] & b[k]);
+  }
+  return c;
+}
+
+//  bitmatrix__and_count_avx2 : comme bitmatrix__and_count_portable, n étant un
+//    multiple de 4 et a et b alignés sur 32 octets. Le nombre de bits à 1 de
+//    chaque octet est obtenu par consultation d'une table de 16 entrées pour
+//    chacun de ses deux quartets, puis les octets sont sommés par blocs de
+//    huit.
+__attribute__((target("avx2")))
+static size_t bitmatrix__and_count_avx2(const uint64_t *a,
+    const uint64_t *b, size_t n) {
+  const __m256i table = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i acc = _mm256_setzero_si256();
+  for (size_t k = 0; k < n; k += 4) {
+    __m256i v = _mm256_and_si256(
+        _mm256_load_si256((const __m256i *) (a + k)),
+        _mm256_load_si256((const __m256i *) (b + k)));
+    __m256i c = _mm256_add_epi8(
+        _mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+        _mm256_shuffle_epi8(table,
+        _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+  }
+  return (size_t) (_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+    + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+}
+
+//  bitmatrix__and_count_avx512 : comme bitmatrix__and_count_portable, n étant
+//    un multiple de 8 et a et b alignés sur 64 octets, au moyen de
+//    l'instruction VPOPCNTQ.
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static size_t bitmatrix__and_count_avx512(const uint64_t *a,
+    const uint64_t *b, size_t n) {
+  __m512i acc = _mm512_setzero_si512();
+  for (size_t k = 0; k < n; k += 8) {
+    __m512i v = _mm512_and_si512(_mm512_load_si512(a + k),
+        _mm512_load_si512(b + k));
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+  }
+  return (size_t) _mm512_reduce_add_epi64(acc);
+}
+
+#endif
+
+//  bitmatrix__kernel : renvoie le meilleur noyau de comptage disponible sur le
+//    processeur courant.
+static size_t (*bitmatrix__kernel(void))(const uint64_t *, const uint64_t *,
+    size_t) {
+#if defined BITMATRIX__X86
+  if (__builtin_cpu_supports("avx512vpopcntdq")) {
+    return bitmatrix__and_count_avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return bitmatrix__and_count_avx2;
+  }
+  if (__builtin_cpu_supports("popcnt")) {
+    return bitmatrix__and_count_popcnt;
+  }
+#endif
+  return bitmatrix__and_count_portable;
+}
+
+size_t bitmatrix_common_count(const bitmatrix *bm, size_t row1,
+    size_t row2) {
+  return bm->and_count(bm->bits + row1 * bm->stride,
+      bm->bits + row2 * bm->stride, bm->stride);
+}
+
+void bitmatrix_intersection_counts(const bitmatrix *bm, size_t i0,
+    size_t i1, size_t *counts) {
+  size_t (*and_count)(const uint64_t *, const uint64_t *, size_t)
+    = bm->and_count;
+  size_t n = bm->nrows;
+  for (size_t i = i0; i < i1; ++i) {
+    for (size_t k = i + 1; k < n; ++k) {
+      counts[(i - i0) * n + k] = 0;
+    }
+  }
+  for (size_t k0 = i0 + 1; k0 < n; k0 += BITMATRIX__TILE_ROWS) {
+    size_t k1 = k0 + BITMATRIX__TILE_ROWS < n ? k0 + BITMATRIX__TILE_ROWS : n;
+    for (size_t w0 = 0; w0 < bm->stride; w0 += BITMATRIX__TILE_WORDS) {
+      size_t len = bm->stride - w0 < BITMATRIX__TILE_WORDS ? bm->stride - w0
+          : BITMATRIX__TILE_WORDS;
+      for (size_t i = i0; i < i1; ++i) {
+        const uint64_t *a = bm->bits + i * bm->stride + w0;
+        for (size_t k = (k0 > i + 1 ? k0 : i + 1); k < k1; ++k) {
+          counts[(i - i0) * n + k]
+            += and_count(a, bm->bits + k * bm->stride + w0, len);
+        }
+      }
+    }
+  }
+}
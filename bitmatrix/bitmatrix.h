@@ -0,0 +1,57 @@
+//  bitmatrix.h : partie interface d'un module de matrice binaire fichiers ×
+//    mots, pour le calcul en bloc des cardinaux des intersections de tous les
+//    couples d'ensembles de mots.
+//  Fonctionnement général :
+//  - la ligne d'un fichier est un ensemble de bits indexé par les
+//    identifiants de mots (voir lexicon.h) : le bit d'un mot vaut 1 si et
+//    seulement si le mot figure dans le fichier ;
+//  - le cardinal de l'intersection de deux ensembles est le nombre de bits à 1
+//    du « et » bit à bit de leurs lignes, calculé mot machine par mot machine
+//    par blocs de lignes et de colonnes tenant en cache ;
+//  - le noyau de comptage est choisi à l'exécution selon le processeur :
+//    AVX-512 VPOPCNTDQ, AVX2, instruction POPCNT ou code portable.
+
+#ifndef BITMATRIX__H
+#define BITMATRIX__H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "wordset.h"
+
+//  struct bitmatrix, bitmatrix : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer une matrice binaire.
+typedef struct bitmatrix bitmatrix;
+
+//  bitmatrix_size : renvoie le nombre d'octets qu'occuperait la matrice
+//    binaire de nrows lignes et ncols colonnes, ou SIZE_MAX si ce nombre
+//    dépasse la capacité de size_t.
+extern size_t bitmatrix_size(size_t nrows, size_t ncols);
+
+//  bitmatrix_build : tente d'allouer une matrice binaire de nrows lignes et
+//    ncols colonnes dont la ligne i contient les identifiants de l'ensemble
+//    sets[i] (une ligne vide si sets[i] vaut un pointeur nul). Les
+//    identifiants doivent être strictement inférieurs à ncols. Renvoie un
+//    pointeur nul en cas de dépassement de capacité. Renvoie sinon un pointeur
+//    vers le contrôleur associé à la matrice.
+extern bitmatrix *bitmatrix_build(wordset **sets, size_t nrows, size_t ncols);
+
+//  bitmatrix_dispose : sans effet si *bmptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de la matrice associée à *bmptr puis
+//    affecte un pointeur nul à *bmptr.
+extern void bitmatrix_dispose(bitmatrix **bmptr);
+
+//  bitmatrix_common_count : renvoie le nombre de colonnes dont les bits valent
+//    1 dans les lignes row1 et row2 de la matrice associée à bm.
+extern size_t bitmatrix_common_count(const bitmatrix *bm, size_t row1,
+    size_t row2);
+
+//  bitmatrix_intersection_counts : pour toute ligne i de l'intervalle
+//    [i0, i1[ et toute ligne k telle que i < k < nrows, où nrows est le nombre
+//    de lignes de la matrice associée à bm, affecte à
+//    counts[(i - i0) * nrows + k] le nombre de colonnes dont les bits valent 1
+//    dans les lignes i et k. Les autres composantes de counts ne sont pas
+//    modifiées.
+extern void bitmatrix_intersection_counts(const bitmatrix *bm, size_t i0,
+    size_t i1, size_t *counts);
+
+#endif
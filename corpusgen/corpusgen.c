@@ -0,0 +1,151 @@
+//  corpusgen.c : partie implantation du module corpusgen.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "corpusgen.h"
+
+//  CORPUSGEN__PUNCTUATION : signes de ponctuation des fichiers générés.
+#define CORPUSGEN__PUNCTUATION ".,;:!?"
+
+//  struct corpusgen, corpusgen : params sont les paramètres du corpus. Le mot
+//    de rang r occupe les composantes d'indices offsets[r] à offsets[r + 1]
+//    exclu du tableau letters ; cdf[r] est la somme des poids des mots de
+//    rangs au plus r.
+struct corpusgen {
+  corpusgen_params params;
+  size_t *offsets;
+  char *letters;
+  double *cdf;
+};
+
+//  corpusgen__mix : renvoie l'image de x par la fonction de mélange de
+//    splitmix64.
+static uint64_t corpusgen__mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9u;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBu;
+  return x ^ (x >> 31);
+}
+
+//  corpusgen__next : avance l'état *state de splitmix64 et renvoie le nombre
+//    pseudo-aléatoire associé.
+static uint64_t corpusgen__next(uint64_t *state) {
+  *state += 0x9E3779B97F4A7C15u;
+  return corpusgen__mix(*state);
+}
+
+//  corpusgen__uniform : renvoie un nombre pseudo-aléatoire de [0, 1[ tiré à
+//    partir de l'état *state.
+static double corpusgen__uniform(uint64_t *state) {
+  return (double) (corpusgen__next(state) >> 11) * 0x1.0p-53;
+}
+
+//  corpusgen__below : renvoie un entier pseudo-aléatoire de [0, n[ tiré à
+//    partir de l'état *state. n doit être non nul.
+static size_t corpusgen__below(uint64_t *state, size_t n) {
+  return (size_t) (corpusgen__next(state) % n);
+}
+
+corpusgen *corpusgen_create(const corpusgen_params *params) {
+  if (params->vocabulary == 0 || params->word_length == 0
+      || !(params->zipf >= 0.0)
+      || !(params->punctuation >= 0.0 && params->punctuation <= 1.0)
+      || params->vocabulary > SIZE_MAX / sizeof(double) - 1
+      || params->word_length > SIZE_MAX / 2 / params->vocabulary) {
+    return nullptr;
+  }
+  corpusgen *cg = malloc(sizeof *cg);
+  if (cg == nullptr) {
+    return nullptr;
+  }
+  size_t v = params->vocabulary;
+  size_t min_length = params->word_length - params->word_length / 2;
+  size_t max_length = params->word_length + params->word_length / 2;
+  *cg = (corpusgen) {
+    .params = *params,
+    .offsets = malloc((v + 1) * sizeof *cg->offsets),
+    .letters = malloc(v * max_length),
+    .cdf = malloc(v * sizeof *cg->cdf),
+  };
+  if (cg->offsets == nullptr || cg->letters == nullptr || cg->cdf == nullptr) {
+    corpusgen_dispose(&cg);
+    return nullptr;
+  }
+  uint64_t state = corpusgen__mix(params->seed);
+  size_t total = 0;
+  double weight = 0.0;
+  for (size_t r = 0; r < v; ++r) {
+    cg->offsets[r] = total;
+    size_t length = min_length
+        + corpusgen__below(&state, max_length - min_length + 1);
+    for (size_t k = 0; k < length; ++k) {
+      cg->letters[total] = (char) ('a' + corpusgen__below(&state, 26));
+      total += 1;
+    }
+    weight += pow((double) (r + 1), -params->zipf);
+    cg->cdf[r] = weight;
+  }
+  cg->offsets[v] = total;
+  return cg;
+}
+
+void corpusgen_dispose(corpusgen **cgptr) {
+  if (*cgptr == nullptr) {
+    return;
+  }
+  free((*cgptr)->cdf);
+  free((*cgptr)->letters);
+  free((*cgptr)->offsets);
+  free(*cgptr);
+  *cgptr = nullptr;
+}
+
+//  corpusgen__draw : renvoie le rang d'un mot du vocabulaire associé à cg tiré
+//    suivant la loi de Zipf à partir de l'état *state.
+static size_t corpusgen__draw(const corpusgen *cg, uint64_t *state) {
+  double u = corpusgen__uniform(state) * cg->cdf[cg->params.vocabulary - 1];
+  size_t lo = 0;
+  size_t hi = cg->params.vocabulary - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cg->cdf[mid] <= u) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+int corpusgen_write(const corpusgen *cg, size_t k, const char *filename,
+    size_t *bytes) {
+  FILE *f = fopen(filename, "w");
+  if (f == nullptr) {
+    return -1;
+  }
+  uint64_t state = corpusgen__mix(cg->params.seed + corpusgen__mix(k + 1));
+  size_t n = 0;
+  for (size_t i = 0; i < cg->params.file_words; ++i) {
+    size_t r = corpusgen__draw(cg, &state);
+    size_t length = cg->offsets[r + 1] - cg->offsets[r];
+    fwrite(cg->letters + cg->offsets[r], 1, length, f);
+    n += length;
+    if (corpusgen__uniform(&state) < cg->params.punctuation) {
+      fputc(CORPUSGEN__PUNCTUATION[corpusgen__below(&state,
+          sizeof CORPUSGEN__PUNCTUATION - 1)], f);
+      n += 1;
+    }
+    fputc((i + 1) % CORPUSGEN_LINE_WORDS == 0
+        || i + 1 == cg->params.file_words ? '\n' : ' ', f);
+    n += 1;
+  }
+  if (ferror(f) != 0) {
+    fclose(f);
+    return -1;
+  }
+  if (fclose(f) != 0) {
+    return -1;
+  }
+  *bytes = n;
+  return 0;
+}
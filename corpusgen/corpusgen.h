@@ -0,0 +1,66 @@
+//  corpusgen.h : partie interface d'un module de génération de corpus
+//    synthétiques reproductibles, pour la mesure des performances.
+//  Fonctionnement général :
+//  - le vocabulaire est formé de mots de lettres minuscules tirés au hasard,
+//    de longueurs réparties uniformément entre la moitié et une fois et demie
+//    la longueur moyenne demandée ; des mots de rangs différents peuvent
+//    coïncider, rarement au-delà de quelques lettres ;
+//  - le mot de rang r, à partir de 0, est tiré avec une probabilité
+//    proportionnelle à 1 / (r + 1)^s (loi de Zipf d'exposant s) ;
+//  - chaque mot est suivi, avec une probabilité donnée, d'un signe de
+//    ponctuation, puis d'une espace ou, tous les CORPUSGEN_LINE_WORDS mots,
+//    d'une fin de ligne ;
+//  - le générateur pseudo-aléatoire est splitmix64 ; le contenu du fichier
+//    d'indice k ne dépend que des paramètres et de k : un corpus est
+//    identique d'une exécution à l'autre, quel que soit l'ordre dans lequel
+//    ses fichiers sont générés.
+
+#ifndef CORPUSGEN__H
+#define CORPUSGEN__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  CORPUSGEN_LINE_WORDS : nombre de mots par ligne des fichiers générés.
+#define CORPUSGEN_LINE_WORDS 12
+
+//  corpusgen_params : paramètres d'un corpus.
+//    Membres :
+//      file_words : nombre de mots de chaque fichier.
+//      vocabulary : nombre de mots du vocabulaire, non nul.
+//      zipf : exposant de la loi de Zipf, positif ou nul.
+//      word_length : longueur moyenne des mots du vocabulaire, non nulle.
+//      punctuation : probabilité, entre 0 et 1, qu'un mot soit suivi d'un
+//                    signe de ponctuation.
+//      seed : graine du générateur pseudo-aléatoire.
+typedef struct {
+  size_t file_words;
+  size_t vocabulary;
+  double zipf;
+  size_t word_length;
+  double punctuation;
+  uint64_t seed;
+} corpusgen_params;
+
+//  struct corpusgen, corpusgen : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour générer un corpus.
+typedef struct corpusgen corpusgen;
+
+//  corpusgen_create : tente d'allouer les ressources nécessaires pour générer
+//    le corpus de paramètres *params. Renvoie un pointeur nul si les
+//    paramètres sont invalides ou en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers le contrôleur associé au corpus.
+extern corpusgen *corpusgen_create(const corpusgen_params *params);
+
+//  corpusgen_dispose : sans effet si *cgptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion du corpus associé à *cgptr puis
+//    affecte un pointeur nul à *cgptr.
+extern void corpusgen_dispose(corpusgen **cgptr);
+
+//  corpusgen_write : écrit le fichier d'indice k du corpus associé à cg sous
+//    le nom filename et affecte à *bytes sa taille en octets. Renvoie 0 en cas
+//    de succès, -1 en cas d'échec d'ouverture ou d'écriture.
+extern int corpusgen_write(const corpusgen *cg, size_t k, const char *filename,
+    size_t *bytes);
+
+#endif
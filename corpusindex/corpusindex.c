@@ -0,0 +1,460 @@
+//  corpusindex.c : partie implantation du module corpusindex.
+
+#define _XOPEN_SOURCE 700
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "corpusindex.h"
+#include "hashtable.h"
+
+//  CORPUSINDEX__MAGIC, CORPUSINDEX__MAGIC_LENGTH : signature, version du
+//    format comprise, des fichiers d'index et sa longueur.
+#define CORPUSINDEX__MAGIC "JDISIX\0\2"
+#define CORPUSINDEX__MAGIC_LENGTH 8
+
+//  CORPUSINDEX__BYTE_ORDER : valeur témoin de l'ordre des octets de la
+//    machine qui a écrit un index.
+#define CORPUSINDEX__BYTE_ORDER UINT32_C(0x01020304)
+
+//  corpusindex__header : en-tête d'un fichier d'index. Il est suivi des
+//    num_files fiches des fichiers, puis, à partir de distances_offset, des
+//    num_files (num_files - 1) / 2 dissimilarités des couples et, à partir de
+//    table_offset, des num_files positions des fiches, jusqu'à la fin du
+//    fichier.
+typedef struct {
+  char magic[CORPUSINDEX__MAGIC_LENGTH];
+  uint32_t byte_order;
+  uint32_t punct;
+  int32_t limit;
+  uint32_t reserved;
+  uint64_t num_files;
+  uint64_t distances_offset;
+  uint64_t table_offset;
+} corpusindex__header;
+
+//  corpusindex__record : en-tête de la fiche d'un fichier. Il est suivi du nom
+//    du fichier, terminé par un caractère nul (name_length + 1 octets), du
+//    texte des messages (diag_length octets) puis des word_count mots, chacun
+//    terminé par un caractère nul (strings_length octets en tout). Les
+//    composants d'identité ne sont significatifs que si indexable est non
+//    nul.
+typedef struct {
+  uint32_t indexable;
+  uint32_t reserved;
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t name_length;
+  uint64_t diag_length;
+  uint64_t strings_length;
+  uint64_t word_count;
+} corpusindex__record;
+
+//  corpusindex__file : fiche d'un fichier d'un index projeté en mémoire.
+//    record est une copie de son en-tête, name, diag et words repèrent son
+//    nom, le texte des messages et ses mots.
+typedef struct {
+  corpusindex__record record;
+  const char *name;
+  const char *diag;
+  const char *words;
+} corpusindex__file;
+
+//  struct corpusindex, corpusindex : l'index est projeté sur les map_length
+//    octets débutant à l'adresse map ; files est le tableau des fiches de ses
+//    num_files fichiers, names la table qui associe à chaque nom de fichier
+//    sa fiche, distances l'adresse de la première dissimilarité.
+struct corpusindex {
+  void *map;
+  size_t map_length;
+  size_t num_files;
+  corpusindex__file *files;
+  hashtable *names;
+  const char *distances;
+};
+
+//  struct corpusindex_writer, corpusindex_writer : l'index est écrit au moyen
+//    du flot f dans le fichier temporaire de nom temp, qui remplace le
+//    fichier de nom path lors de l'achèvement. header est son en-tête,
+//    position le nombre d'octets écrits. offsets est le tableau des positions
+//    des fiches des num_files fichiers, dont added ont été ajoutés ;
+//    distances est le nombre de dissimilarités écrites, failed indique
+//    qu'une écriture a échoué.
+struct corpusindex_writer {
+  char *path;
+  char *temp;
+  FILE *f;
+  corpusindex__header header;
+  uint64_t position;
+  uint64_t *offsets;
+  size_t num_files;
+  size_t added;
+  uint64_t distances;
+  bool failed;
+};
+
+//  corpusindex__compar : fonction de comparaison des noms de fichiers pour la
+//    table des noms.
+static int corpusindex__compar(const void *a, const void *b) {
+  return strcmp(a, b);
+}
+
+//  corpusindex__hashfun : fonction de pré-hachage (FNV-1a) des noms de
+//    fichiers pour la table des noms.
+static size_t corpusindex__hashfun(const void *key) {
+  const unsigned char *s = key;
+  uint64_t h = UINT64_C(0xCBF29CE484222325);
+  for (; *s != '\0'; ++s) {
+    h ^= *s;
+    h *= UINT64_C(0x100000001B3);
+  }
+  return (size_t) h;
+}
+
+//  corpusindex__pairs : renvoie le nombre de couples (j, k) avec j < k de n
+//    fichiers.
+static uint64_t corpusindex__pairs(uint64_t n) {
+  return n < 2 ? 0 : n * (n - 1) / 2;
+}
+
+//  corpusindex__fill_identity : affecte aux composants d'identité de l'en-tête
+//    de fiche pointé par r les valeurs tirées de *st.
+static void corpusindex__fill_identity(corpusindex__record *r,
+    const struct stat *st) {
+  r->indexable = 1;
+  r->dev = (uint64_t) st->st_dev;
+  r->ino = (uint64_t) st->st_ino;
+  r->size = (uint64_t) st->st_size;
+  r->mtime_sec = (int64_t) st->st_mtim.tv_sec;
+  r->mtime_nsec = (int64_t) st->st_mtim.tv_nsec;
+}
+
+//  corpusindex__load_file : tente de remplir la fiche pointée par file à
+//    partir de celle qui débute à la position offset de l'index de map_length
+//    octets projeté à l'adresse map, les fiches devant précéder la position
+//    end. Renvoie 0 en cas de succès, -1 si la fiche est invalide.
+static int corpusindex__load_file(corpusindex__file *file, const char *map,
+    uint64_t offset, uint64_t end) {
+  corpusindex__record r;
+  if (offset > end || end - offset < sizeof r) {
+    return -1;
+  }
+  memcpy(&r, map + offset, sizeof r);
+  uint64_t avail = end - offset - sizeof r;
+  if (r.name_length >= avail
+      || r.diag_length > avail - r.name_length - 1
+      || r.strings_length > avail - r.name_length - 1 - r.diag_length
+      || r.word_count > r.strings_length) {
+    return -1;
+  }
+  const char *name = map + offset + sizeof r;
+  const char *words = name + r.name_length + 1 + r.diag_length;
+  size_t n = (size_t) r.strings_length;
+  if (memchr(name, '\0', (size_t) r.name_length) != nullptr
+      || name[r.name_length] != '\0'
+      || (n > 0 && words[n - 1] != '\0')) {
+    return -1;
+  }
+  uint64_t count = 0;
+  for (const char *p = words; p < words + n; ++count) {
+    p = (const char *) memchr(p, '\0', (size_t) (words + n - p)) + 1;
+  }
+  if (count != r.word_count) {
+    return -1;
+  }
+  *file = (corpusindex__file) {
+    .record = r,
+    .name = name,
+    .diag = name + r.name_length + 1,
+    .words = words,
+  };
+  return 0;
+}
+
+corpusindex *corpusindex_load(const char *filename, int limit, bool punct) {
+  corpusindex *ci = nullptr;
+  corpusindex__file *files = nullptr;
+  hashtable *names = nullptr;
+  void *map = MAP_FAILED;
+  size_t length = 0;
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) != 0
+      || st.st_size < (off_t) sizeof(corpusindex__header)) {
+    goto cleanup;
+  }
+  length = (size_t) st.st_size;
+  map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    goto cleanup;
+  }
+  corpusindex__header h;
+  memcpy(&h, map, sizeof h);
+  //  Le nombre de fichiers est borné avant le calcul du nombre de couples, qui
+  //    ne peut alors déborder.
+  if (memcmp(h.magic, CORPUSINDEX__MAGIC, CORPUSINDEX__MAGIC_LENGTH) != 0
+      || h.byte_order != CORPUSINDEX__BYTE_ORDER
+      || h.punct != (uint32_t) punct || h.limit != limit
+      || h.num_files > UINT32_MAX
+      || h.table_offset > length
+      || (length - h.table_offset) / sizeof(uint64_t) != h.num_files
+      || (length - h.table_offset) % sizeof(uint64_t) != 0
+      || h.distances_offset < sizeof h
+      || h.distances_offset > h.table_offset
+      || (h.table_offset - h.distances_offset) / sizeof(float)
+      != corpusindex__pairs(h.num_files)
+      || (h.table_offset - h.distances_offset) % sizeof(float) != 0) {
+    goto cleanup;
+  }
+  size_t n = (size_t) h.num_files;
+  files = malloc((n == 0 ? 1 : n) * sizeof *files);
+  names = hashtable_empty(corpusindex__compar, corpusindex__hashfun, 0.75);
+  if (files == nullptr || names == nullptr) {
+    goto cleanup;
+  }
+  const char *table = (const char *) map + h.table_offset;
+  for (size_t k = 0; k < n; ++k) {
+    uint64_t offset;
+    memcpy(&offset, table + k * sizeof offset, sizeof offset);
+    if (offset < sizeof h
+        || corpusindex__load_file(&files[k], map, offset,
+        h.distances_offset) != 0
+        || hashtable_add(names, files[k].name, &files[k]) == nullptr) {
+      goto cleanup;
+    }
+  }
+  ci = malloc(sizeof *ci);
+  if (ci == nullptr) {
+    goto cleanup;
+  }
+  *ci = (corpusindex) {
+    .map = map,
+    .map_length = length,
+    .num_files = n,
+    .files = files,
+    .names = names,
+    .distances = (const char *) map + h.distances_offset,
+  };
+  map = MAP_FAILED;
+  files = nullptr;
+  names = nullptr;
+cleanup:
+  hashtable_dispose(&names);
+  free(files);
+  if (map != MAP_FAILED) {
+    munmap(map, length);
+  }
+  if (fd != -1) {
+    close(fd);
+  }
+  return ci;
+}
+
+void corpusindex_dispose(corpusindex **ciptr) {
+  if (*ciptr == nullptr) {
+    return;
+  }
+  hashtable_dispose(&(*ciptr)->names);
+  free((*ciptr)->files);
+  munmap((*ciptr)->map, (*ciptr)->map_length);
+  free(*ciptr);
+  *ciptr = nullptr;
+}
+
+size_t corpusindex_count(const corpusindex *ci) {
+  return ci->num_files;
+}
+
+size_t corpusindex_find(const corpusindex *ci, const char *name,
+    const struct stat *st) {
+  const corpusindex__file *file = hashtable_search(ci->names, name);
+  if (file == nullptr || file->record.indexable == 0) {
+    return CORPUSINDEX_NONE;
+  }
+  corpusindex__record expected = file->record;
+  corpusindex__fill_identity(&expected, st);
+  if (memcmp(&expected, &file->record, sizeof expected) != 0) {
+    return CORPUSINDEX_NONE;
+  }
+  return (size_t) (file - ci->files);
+}
+
+const char *corpusindex_words(const corpusindex *ci, size_t slot,
+    size_t *count) {
+  *count = (size_t) ci->files[slot].record.word_count;
+  return ci->files[slot].words;
+}
+
+const char *corpusindex_diag(const corpusindex *ci, size_t slot,
+    size_t *length) {
+  *length = (size_t) ci->files[slot].record.diag_length;
+  return ci->files[slot].diag;
+}
+
+float corpusindex_distance(const corpusindex *ci, size_t slot1,
+    size_t slot2) {
+  size_t j = slot1 < slot2 ? slot1 : slot2;
+  size_t k = slot1 < slot2 ? slot2 : slot1;
+  uint64_t i = corpusindex__pairs(ci->num_files)
+      - corpusindex__pairs(ci->num_files - j) + (k - j - 1);
+  float d;
+  memcpy(&d, ci->distances + i * sizeof d, sizeof d);
+  return d;
+}
+
+//  corpusindex__write : écrit au moyen du flot de l'index en cours d'écriture
+//    associé à w les n octets de la zone pointée par p. Renvoie 0 en cas de
+//    succès, -1 en cas d'échec.
+static int corpusindex__write(corpusindex_writer *w, const void *p,
+    size_t n) {
+  if (w->failed || fwrite(p, 1, n, w->f) != n) {
+    w->failed = true;
+    return -1;
+  }
+  w->position += n;
+  return 0;
+}
+
+corpusindex_writer *corpusindex_writer_create(const char *filename,
+    int limit, bool punct, size_t num_files) {
+  corpusindex_writer *w = malloc(sizeof *w);
+  if (w == nullptr) {
+    return nullptr;
+  }
+  size_t n = strlen(filename) + strlen(".XXXXXX") + 1;
+  *w = (corpusindex_writer) {
+    .path = strdup(filename),
+    .temp = malloc(n),
+    .f = nullptr,
+    .position = 0,
+    .offsets = malloc((num_files == 0 ? 1 : num_files) * sizeof(uint64_t)),
+    .num_files = num_files,
+    .added = 0,
+    .distances = 0,
+    .failed = false,
+  };
+  if (w->path == nullptr || w->temp == nullptr || w->offsets == nullptr) {
+    goto error;
+  }
+  snprintf(w->temp, n, "%s.XXXXXX", filename);
+  int fd = mkstemp(w->temp);
+  if (fd == -1) {
+    goto error;
+  }
+  w->f = fdopen(fd, "wb");
+  if (w->f == nullptr) {
+    close(fd);
+    unlink(w->temp);
+    goto error;
+  }
+  memset(&w->header, 0, sizeof w->header);
+  memcpy(w->header.magic, CORPUSINDEX__MAGIC, CORPUSINDEX__MAGIC_LENGTH);
+  w->header.byte_order = CORPUSINDEX__BYTE_ORDER;
+  w->header.punct = punct;
+  w->header.limit = limit;
+  w->header.num_files = num_files;
+  if (corpusindex__write(w, &w->header, sizeof w->header) != 0) {
+    corpusindex_writer_discard(&w);
+    return nullptr;
+  }
+  return w;
+error:
+  free(w->offsets);
+  free(w->temp);
+  free(w->path);
+  free(w);
+  return nullptr;
+}
+
+int corpusindex_writer_add_file(corpusindex_writer *w, const char *name,
+    const struct stat *st, const char * const *words, size_t count,
+    const char *diag, size_t diag_length) {
+  if (w->added == w->num_files) {
+    w->failed = true;
+    return -1;
+  }
+  corpusindex__record r;
+  memset(&r, 0, sizeof r);
+  if (st != nullptr) {
+    corpusindex__fill_identity(&r, st);
+  }
+  r.name_length = strlen(name);
+  r.diag_length = diag_length;
+  r.word_count = count;
+  for (size_t k = 0; k < count; ++k) {
+    r.strings_length += strlen(words[k]) + 1;
+  }
+  w->offsets[w->added] = w->position;
+  w->added += 1;
+  corpusindex__write(w, &r, sizeof r);
+  corpusindex__write(w, name, (size_t) r.name_length + 1);
+  corpusindex__write(w, diag, diag_length);
+  for (size_t k = 0; k < count; ++k) {
+    corpusindex__write(w, words[k], strlen(words[k]) + 1);
+  }
+  if (w->added == w->num_files) {
+    w->header.distances_offset = w->position;
+  }
+  return w->failed ? -1 : 0;
+}
+
+int corpusindex_writer_put_distance(corpusindex_writer *w, float d) {
+  if (w->added < w->num_files) {
+    w->failed = true;
+    return -1;
+  }
+  w->distances += 1;
+  return corpusindex__write(w, &d, sizeof d);
+}
+
+int corpusindex_writer_commit(corpusindex_writer **wptr) {
+  corpusindex_writer *w = *wptr;
+  if (w->added < w->num_files
+      || w->distances != corpusindex__pairs(w->num_files)) {
+    w->failed = true;
+  }
+  if (w->num_files == 0) {
+    w->header.distances_offset = w->position;
+  }
+  w->header.table_offset = w->position;
+  corpusindex__write(w, w->offsets, w->num_files * sizeof *w->offsets);
+  if (w->failed || fseek(w->f, 0, SEEK_SET) != 0
+      || fwrite(&w->header, sizeof w->header, 1, w->f) != 1) {
+    corpusindex_writer_discard(wptr);
+    return -1;
+  }
+  int r = fclose(w->f);
+  w->f = nullptr;
+  if (r != 0 || rename(w->temp, w->path) != 0) {
+    unlink(w->temp);
+    r = -1;
+  }
+  free(w->offsets);
+  free(w->temp);
+  free(w->path);
+  free(w);
+  *wptr = nullptr;
+  return r == 0 ? 0 : -1;
+}
+
+void corpusindex_writer_discard(corpusindex_writer **wptr) {
+  if (*wptr == nullptr) {
+    return;
+  }
+  corpusindex_writer *w = *wptr;
+  if (w->f != nullptr) {
+    fclose(w->f);
+    unlink(w->temp);
+  }
+  free(w->offsets);
+  free(w->temp);
+  free(w->path);
+  free(w);
+  *wptr = nullptr;
+}
@@ -0,0 +1,121 @@
+//  corpusindex.h : partie interface d'un module d'index sur disque d'un
+//    corpus de fichiers.
+//  Fonctionnement général :
+//  - un index mémorise, pour des options de lecture données (limite de
+//    longueur des mots et traitement de la ponctuation), les fichiers d'un
+//    corpus, dans l'ordre, ainsi que les dissimilarités de tous les couples
+//    de ces fichiers ;
+//  - chaque fichier y figure par son nom, son identité lors de sa lecture
+//    (périphérique, numéro d'inœud, taille et date de dernière modification)
+//    s'il s'agit d'un fichier ordinaire, la suite de ses mots distincts et les
+//    données permettant de reproduire les messages émis lors de sa lecture,
+//    sous le nom qu'aura alors le fichier. Un fichier de l'index est
+//    désigné par son rang, entre 0 et le nombre de fichiers exclu ;
+//  - un index est projeté en mémoire et lu sur place ;
+//  - un index est écrit dans un fichier temporaire qui est ensuite renommé,
+//    de sorte qu'un index incomplet n'est jamais lu.
+
+#ifndef CORPUSINDEX__H
+#define CORPUSINDEX__H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+//  CORPUSINDEX_NONE : valeur renvoyée par corpusindex_find pour un fichier
+//    absent de l'index.
+#define CORPUSINDEX_NONE SIZE_MAX
+
+//  struct corpusindex, corpusindex : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer un index projeté en
+//    mémoire.
+typedef struct corpusindex corpusindex;
+
+//  struct corpusindex_writer, corpusindex_writer : type et nom de type d'un
+//    contrôleur regroupant les informations nécessaires pour gérer l'écriture
+//    d'un index.
+typedef struct corpusindex_writer corpusindex_writer;
+
+//  corpusindex_load : tente de projeter en mémoire l'index du fichier
+//    filename. Renvoie un pointeur nul si ce fichier est absent, s'il n'est
+//    pas un index valide, s'il a été écrit pour une autre limite de longueur
+//    que limit ou un autre traitement de la ponctuation que punct, ou en cas
+//    de dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé à l'index.
+extern corpusindex *corpusindex_load(const char *filename, int limit,
+    bool punct);
+
+//  corpusindex_dispose : sans effet si *ciptr vaut un pointeur nul. Libère
+//    sinon les ressources allouées à la gestion de l'index associé à *ciptr,
+//    ce qui invalide les chaînes qu'il a fournies, puis affecte un pointeur
+//    nul à *ciptr.
+extern void corpusindex_dispose(corpusindex **ciptr);
+
+//  corpusindex_count : renvoie le nombre de fichiers de l'index associé à ci.
+extern size_t corpusindex_count(const corpusindex *ci);
+
+//  corpusindex_find : renvoie le rang dans l'index associé à ci d'un fichier
+//    ordinaire de nom name dont l'identité lors de sa lecture est son
+//    identité courante *st. Renvoie CORPUSINDEX_NONE s'il n'en existe pas.
+extern size_t corpusindex_find(const corpusindex *ci, const char *name,
+    const struct stat *st);
+
+//  corpusindex_words : affecte à *count le nombre de mots du fichier de rang
+//    slot de l'index associé à ci et renvoie l'adresse du premier d'entre eux.
+//    Les mots se suivent, chacun terminé par un caractère nul.
+extern const char *corpusindex_words(const corpusindex *ci, size_t slot,
+    size_t *count);
+
+//  corpusindex_diag : affecte à *length la longueur des données des messages
+//    mémorisées pour le fichier de rang slot de l'index associé à ci et
+//    renvoie leur adresse.
+extern const char *corpusindex_diag(const corpusindex *ci, size_t slot,
+    size_t *length);
+
+//  corpusindex_distance : renvoie la dissimilarité mémorisée par l'index
+//    associé à ci pour le couple des fichiers de rangs distincts slot1 et
+//    slot2.
+extern float corpusindex_distance(const corpusindex *ci, size_t slot1,
+    size_t slot2);
+
+//  corpusindex_writer_create : tente d'allouer les ressources nécessaires pour
+//    écrire, à la place du fichier filename, l'index de num_files fichiers
+//    pour la limite de longueur limit et le traitement de la ponctuation
+//    punct. Les fichiers doivent ensuite être ajoutés dans l'ordre par
+//    corpusindex_writer_add_file, puis les dissimilarités de leurs couples
+//    (j, k) avec j < k, dans l'ordre lexicographique des couples, par
+//    corpusindex_writer_put_distance. Renvoie un pointeur nul en cas d'échec.
+//    Renvoie sinon un pointeur vers le contrôleur associé à l'écriture.
+extern corpusindex_writer *corpusindex_writer_create(const char *filename,
+    int limit, bool punct, size_t num_files);
+
+//  corpusindex_writer_add_file : ajoute à l'index en cours d'écriture associé
+//    à w le fichier de nom name, d'identité *st avant sa lecture ou dont
+//    l'identité n'est pas mémorisée si st vaut un pointeur nul. Ses mots sont
+//    les count chaînes du tableau words, les données des messages émis lors
+//    de sa lecture, dont l'utilisateur choisit le format, les diag_length
+//    octets de la zone pointée par diag. Renvoie 0 en cas de succès, -1 en
+//    cas d'échec.
+extern int corpusindex_writer_add_file(corpusindex_writer *w,
+    const char *name, const struct stat *st, const char * const *words,
+    size_t count, const char *diag, size_t diag_length);
+
+//  corpusindex_writer_put_distance : ajoute la dissimilarité d à l'index en
+//    cours d'écriture associé à w. Renvoie 0 en cas de succès, -1 en cas
+//    d'échec.
+extern int corpusindex_writer_put_distance(corpusindex_writer *w, float d);
+
+//  corpusindex_writer_commit : achève l'écriture de l'index associé à *wptr,
+//    qui remplace alors le fichier de l'index, libère les ressources allouées
+//    à sa gestion puis affecte un pointeur nul à *wptr. Renvoie 0 en cas de
+//    succès, -1 en cas d'échec ou si des fichiers ou des dissimilarités
+//    manquent ; le fichier de l'index est alors laissé inchangé.
+extern int corpusindex_writer_commit(corpusindex_writer **wptr);
+
+//  corpusindex_writer_discard : sans effet si *wptr vaut un pointeur nul.
+//    Abandonne sinon l'écriture de l'index associé à *wptr, libère les
+//    ressources allouées à sa gestion puis affecte un pointeur nul à *wptr.
+extern void corpusindex_writer_discard(corpusindex_writer **wptr);
+
+#endif
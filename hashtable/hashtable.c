@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 #include "hashtable.h"
+#include "slab.h"
 
 //  struct hashtable, hashtable : gestion du chainage séparé par liste dynamique
 //    simplement chainée. Le composant compar mémorise la fonction de
@@ -11,13 +12,18 @@
 //    le taux de remplissage maximum toléré de la table. Le tableau de hachage
 //    est alloué dynamiquement ; son adresse et sa longueur (le nombre de
 //    compartiments) sont mémorisés par les composants hasharray et nslots. Le
-//    composant nentries mémorise le nombre d'entrées de la table.
+//    composant nentries mémorise le nombre d'entrées de la table. Chaque
+//    cellule mémorise le pré-hachage hash de sa clé : la fonction de
+//    comparaison n'est appelée que pour les clés de même pré-hachage et
+//    l'agrandissement du tableau ne rappelle pas la fonction de pré-hachage.
+//    Les cellules sont allouées par blocs dans la réserve cells (voir slab.h).
 
 typedef struct cell cell;
 
 struct cell {
   const void *keyref;
   const void *valref;
+  size_t hash;
   cell *next;
 };
 
@@ -28,18 +34,22 @@ struct hashtable {
   cell **hasharray;
   size_t nslots;
   size_t nentries;
+  slab *cells;
 };
 
-#define HASHVAL(__hashfun, __nslots, __keyref)                                 \
-  (__hashfun(__keyref) % (__nslots))
+#define HASHVAL(__hash, __nslots)                                              \
+  ((__hash) % (__nslots))
 
 //  hashtable__search : recherche dans la table de hachage associé à ht une clé
-//    égale à keyref au sens de compar. Renvoie l'adresse du pointeur qui repère
-//    la cellule qui contient cette occurrence si elle existe. Renvoie sinon
-//    l'adresse du pointeur qui marque la fin de la liste.
-static cell **hashtable__search(const hashtable *ht, const void *keyref) {
-  cell * const *pp = &ht->hasharray[HASHVAL(ht->hashfun, ht->nslots, keyref)];
-  while (*pp != nullptr && ht->compar(keyref, (*pp)->keyref) != 0) {
+//    égale à keyref au sens de compar, de pré-hachage hash. Renvoie l'adresse
+//    du pointeur qui repère la cellule qui contient cette occurrence si elle
+//    existe. Renvoie sinon l'adresse du pointeur qui marque la fin de la
+//    liste.
+static cell **hashtable__search(const hashtable *ht, const void *keyref,
+    size_t hash) {
+  cell * const *pp = &ht->hasharray[HASHVAL(hash, ht->nslots)];
+  while (*pp != nullptr
+      && ((*pp)->hash != hash || ht->compar(keyref, (*pp)->keyref) != 0)) {
     pp = &(*pp)->next;
   }
   return (cell **) pp;
@@ -60,7 +70,7 @@ static int hashtable__increase(hashtable *ht) {
     cell **pp_ = &a[k_];
     cell **pp = &a[k_ + m_];
     while (*pp_ != nullptr) {
-      if (HASHVAL(ht->hashfun, m, (*pp_)->keyref) < m_) {
+      if (HASHVAL((*pp_)->hash, m) < m_) {
         pp_ = &(*pp_)->next;
       } else {
         *pp = *pp_;
@@ -89,9 +99,11 @@ hashtable *hashtable_empty(int (*compar)(const void *, const void *),
   }
   hashtable *ht = malloc(sizeof(hashtable));
   cell **a = malloc(m * sizeof(cell *));
-  if (ht == nullptr || a == nullptr) {
+  slab *cells = slab_empty(sizeof(cell));
+  if (ht == nullptr || a == nullptr || cells == nullptr) {
     free(ht);
     free(a);
+    slab_dispose(&cells);
     return nullptr;
   }
   for (size_t k = 0; k < m; ++k) {
@@ -103,6 +115,7 @@ hashtable *hashtable_empty(int (*compar)(const void *, const void *),
   ht->hasharray = a;
   ht->nslots = m;
   ht->nentries = 0;
+  ht->cells = cells;
   return ht;
 }
 
@@ -110,14 +123,7 @@ void hashtable_dispose(hashtable **htptr) {
   if (*htptr == nullptr) {
     return;
   }
-  for (size_t k = 0; k < (*htptr)->nslots; ++k) {
-    cell *p = (*htptr)->hasharray[k];
-    while (p != nullptr) {
-      cell *t = p;
-      p = p->next;
-      free(t);
-    }
-  }
+  slab_dispose(&(*htptr)->cells);
   free((*htptr)->hasharray);
   free(*htptr);
   *htptr = nullptr;
@@ -127,7 +133,8 @@ void *hashtable_add(hashtable *ht, const void *keyref, const void *valref) {
   if (valref == nullptr) {
     return nullptr;
   }
-  cell **pp = hashtable__search(ht, keyref);
+  size_t hash = ht->hashfun(keyref);
+  cell **pp = hashtable__search(ht, keyref, hash);
   if (*pp != nullptr) {
     const void *r = (*pp)->valref;
     (*pp)->valref = valref;
@@ -137,14 +144,18 @@ void *hashtable_add(hashtable *ht, const void *keyref, const void *valref) {
     if (hashtable__increase(ht) != 0) {
       return nullptr;
     }
-    pp = hashtable__search(ht, keyref);
+    pp = &ht->hasharray[HASHVAL(hash, ht->nslots)];
+    while (*pp != nullptr) {
+      pp = &(*pp)->next;
+    }
   }
-  cell *p = malloc(sizeof(cell));
+  cell *p = slab_alloc(ht->cells);
   if (p == nullptr) {
     return nullptr;
   }
   p->keyref = keyref;
   p->valref = valref;
+  p->hash = hash;
   p->next = *pp;
   *pp = p;
   ht->nentries += 1;
@@ -152,20 +163,20 @@ void *hashtable_add(hashtable *ht, const void *keyref, const void *valref) {
 }
 
 void *hashtable_remove(hashtable *ht, const void *keyref) {
-  cell **pp = hashtable__search(ht, keyref);
+  cell **pp = hashtable__search(ht, keyref, ht->hashfun(keyref));
   if (*pp == nullptr) {
     return nullptr;
   }
   cell *p = *pp;
   const void *r = p->valref;
   *pp = p->next;
-  free(p);
+  slab_free(ht->cells, p);
   ht->nentries -= 1;
   return (void *) r;
 }
 
 void *hashtable_search(hashtable *ht, const void *keyref) {
-  const cell *p = *hashtable__search(ht, keyref);
+  const cell *p = *hashtable__search(ht, keyref, ht->hashfun(keyref));
   return p == nullptr ? nullptr : (void *) p->valref;
 }
 
@@ -1,9 +1,22 @@
 //  hashtable_ip.h : précisions sur l'implantation du module hashtable.
 
-//  Le nombre de compartiments varie au gré des besoins mais est toujours une
-//    puissance de 2. La fonction de hachage est la combinaison de la fonction
-//    de pré-hachage passée en paramètre et d'un modulo par le nombre de
-//    compartiments.
+//  Deux implantations sont disponibles, au choix à la compilation :
+//  - hashtable.c : chainage séparé. Le nombre de compartiments varie au gré
+//      des besoins mais est toujours une puissance de 2. La fonction de
+//      hachage est la combinaison de la fonction de pré-hachage passée en
+//      paramètre et d'un modulo par le nombre de compartiments. Le
+//      pré-hachage de chaque clé est mémorisé dans sa cellule : la fonction
+//      de comparaison n'est appelée que pour les clés de même pré-hachage et
+//      l'agrandissement du tableau ne rappelle pas la fonction de
+//      pré-hachage. Les cellules sont allouées par blocs (voir slab.h) et
+//      libérées tous à la fois ;
+//  - hashtable_oa.c : adressage ouvert par sondage linéaire « Robin des
+//      bois », sans allocation par entrée. Le nombre de cases est toujours une
+//      puissance de 2 et le taux de remplissage maximum effectif est au plus
+//      0.875. Comme dans hashtable.c, le pré-hachage de chaque clé est
+//      mémorisé, dans sa case. Le retrait se fait par décalage arrière, sans
+//      marque de case supprimée. Dans le bilan de santé, maxlen et poscurr se
+//      rapportent aux longueurs de sondage des clés présentes.
 
 //  Lorsqu'ils ne sont pas constants, les couts sont exprimés en fonction du
 //    nombre de couples (clé, valeur) présents dans la table.
@@ -11,8 +24,10 @@
 //    de l'uniformité de la fonction de hachage.
 
 //  hashtable_empty : temps constant ; espace constant.
-//  hashtable_dispose : temps en O(N + M) où N est le nombre d'entrées et M le
-//                     nombre de compartiments ; espace constant.
+//  hashtable_dispose : temps en O(N / B + M) où N est le nombre d'entrées, B
+//                     le nombre maximal d'entrées d'un bloc de la réserve
+//                     (voir slab.h) et M le nombre de compartiments, donc
+//                     linéaire en N ; espace constant.
 //  hashtable_add : temps amorti constant ; espace constant.
 //  hashtable_remove : temps constant ; espace constant.
 //  hashtable_search : temps constant ; espace constant.
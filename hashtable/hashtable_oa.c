@@ -0,0 +1,274 @@
+//  hashtable_oa.c : partie implantation d'un module polymorphe pour la
+//    spécification TABLE du TDA Table(T, T') dans le cas d'une table de hachage
+//    par adressage ouvert ainsi que pour une extension optionnelle. Cette
+//    implantation est une alternative à celle de hashtable.c, retenue à la
+//    compilation (voir hashtable_ip.h).
+
+#include <stdint.h>
+#include "hashtable.h"
+
+//  HASHTABLE__LFMAX_CAP : taux de remplissage maximum effectif lorsque celui
+//    demandé est supérieur. L'adressage ouvert exige qu'une case au moins
+//    reste libre et se dégrade rapidement au-delà de ce taux.
+#define HASHTABLE__LFMAX_CAP 0.875
+
+//  hashtable__slot : case du tableau de hachage. Le composant dist vaut zéro
+//    si la case est libre. Il vaut sinon un de plus que la distance entre la
+//    case et la case de départ de la clé de référence keyref, de valeur
+//    associée de référence valref et de pré-hachage hash.
+typedef struct {
+  const void *keyref;
+  const void *valref;
+  size_t hash;
+  size_t dist;
+} hashtable__slot;
+
+//  struct hashtable, hashtable : gestion de l'adressage ouvert par sondage
+//    linéaire « Robin des bois » : lors d'une insertion, une clé prend la case
+//    d'une clé plus proche qu'elle de sa case de départ, qui poursuit le
+//    sondage à sa place. Le composant compar mémorise la fonction de
+//    comparaison des clés, hashfun, leur fonction de pré-hachage, lfmax, le
+//    taux de remplissage maximum effectif de la table. Le tableau de hachage
+//    est alloué dynamiquement ; son adresse et sa longueur (le nombre de
+//    cases, une puissance de 2) sont mémorisées par les composants slots et
+//    nslots ; shift vaut 64 moins le logarithme en base 2 de nslots. Le
+//    composant nentries mémorise le nombre d'entrées de la table.
+struct hashtable {
+  int (*compar)(const void *, const void *);
+  size_t (*hashfun)(const void *);
+  double lfmax;
+  hashtable__slot *slots;
+  size_t nslots;
+  unsigned int shift;
+  size_t nentries;
+};
+
+//  hashtable__home : renvoie la case de départ d'une clé de pré-hachage hash
+//    dans la table associée à ht. Les bits de poids faible des pré-hachages
+//    usuels étant de piètre qualité, la case est tirée des bits de poids fort
+//    du produit de hash par la partie fractionnaire du nombre d'or.
+static size_t hashtable__home(const hashtable *ht, size_t hash) {
+  if (ht->shift >= 64) {
+    return 0;
+  }
+  return (size_t) (((uint64_t) hash * UINT64_C(0x9E3779B97F4A7C15))
+         >> ht->shift);
+}
+
+//  hashtable__search : recherche dans la table de hachage associée à ht une clé
+//    égale à keyref au sens de compar, de pré-hachage hash. Les cases dont le
+//    pré-hachage diffère de hash sont écartées sans appel à compar. Renvoie
+//    l'indice de la case qui contient cette occurrence si elle existe, nslots
+//    sinon.
+static size_t hashtable__search(const hashtable *ht, const void *keyref,
+    size_t hash) {
+  size_t mask = ht->nslots - 1;
+  size_t i = hashtable__home(ht, hash);
+  for (size_t d = 1;; ++d) {
+    const hashtable__slot *s = &ht->slots[i];
+    if (s->dist < d) {
+      return ht->nslots;
+    }
+    if (s->hash == hash && ht->compar(keyref, s->keyref) == 0) {
+      return i;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+//  hashtable__place : range l'entrée e, dont la distance vaut un, dans le
+//    tableau de hachage de la table associée à ht, qui ne contient aucune clé
+//    égale et possède au moins une case libre.
+static void hashtable__place(hashtable *ht, hashtable__slot e) {
+  size_t mask = ht->nslots - 1;
+  size_t i = hashtable__home(ht, e.hash);
+  while (ht->slots[i].dist != 0) {
+    if (ht->slots[i].dist < e.dist) {
+      hashtable__slot t = ht->slots[i];
+      ht->slots[i] = e;
+      e = t;
+    }
+    i = (i + 1) & mask;
+    e.dist += 1;
+  }
+  ht->slots[i] = e;
+}
+
+//  hashtable__alloc_slots : renvoie l'adresse d'un tableau de m cases libres,
+//    ou un pointeur nul en cas de dépassement de capacité.
+static hashtable__slot *hashtable__alloc_slots(size_t m) {
+  if (m > PTRDIFF_MAX / sizeof(hashtable__slot)) {
+    return nullptr;
+  }
+  return calloc(m, sizeof(hashtable__slot));
+}
+
+//  hashtable__increase : double le nombre de cases de la table de hachage
+//    associée à ht. Les entrées sont replacées selon leur pré-hachage
+//    mémorisé, sans appel à hashfun. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int hashtable__increase(hashtable *ht) {
+  size_t m_ = ht->nslots;
+  hashtable__slot *a_ = ht->slots;
+  hashtable__slot *a = hashtable__alloc_slots(2 * m_);
+  if (a == nullptr) {
+    return -1;
+  }
+  ht->slots = a;
+  ht->nslots = 2 * m_;
+  ht->shift -= 1;
+  for (size_t k = 0; k < m_; ++k) {
+    if (a_[k].dist != 0) {
+      hashtable__slot e = a_[k];
+      e.dist = 1;
+      hashtable__place(ht, e);
+    }
+  }
+  free(a_);
+  return 0;
+}
+
+hashtable *hashtable_empty(int (*compar)(const void *, const void *),
+    size_t (*hashfun)(const void *), double lfmax) {
+  //  Calcul du nombre de cases d'un tableau de hachage permettant de contenir
+  //    au moins une entrée sous la contrainte du taux de remplissage maximum
+  //    effectif. Le résultat du calcul est la valeur finale de m.
+  if (lfmax < 2 * sizeof(hashtable__slot) / (double) PTRDIFF_MAX) {
+    return nullptr;
+  }
+  if (lfmax > HASHTABLE__LFMAX_CAP) {
+    lfmax = HASHTABLE__LFMAX_CAP;
+  }
+  size_t m = 1;
+  unsigned int shift = 64;
+  while ((double) m * lfmax < 1.0) {
+    m *= 2;
+    shift -= 1;
+  }
+  hashtable *ht = malloc(sizeof(hashtable));
+  hashtable__slot *a = hashtable__alloc_slots(m);
+  if (ht == nullptr || a == nullptr) {
+    free(ht);
+    free(a);
+    return nullptr;
+  }
+  ht->compar = compar;
+  ht->hashfun = hashfun;
+  ht->lfmax = lfmax;
+  ht->slots = a;
+  ht->nslots = m;
+  ht->shift = shift;
+  ht->nentries = 0;
+  return ht;
+}
+
+void hashtable_dispose(hashtable **htptr) {
+  if (*htptr == nullptr) {
+    return;
+  }
+  free((*htptr)->slots);
+  free(*htptr);
+  *htptr = nullptr;
+}
+
+void *hashtable_add(hashtable *ht, const void *keyref, const void *valref) {
+  if (valref == nullptr) {
+    return nullptr;
+  }
+  size_t hash = ht->hashfun(keyref);
+  size_t i = hashtable__search(ht, keyref, hash);
+  if (i != ht->nslots) {
+    const void *r = ht->slots[i].valref;
+    ht->slots[i].valref = valref;
+    return (void *) r;
+  }
+  if ((double) (ht->nentries + 1) > ht->lfmax * (double) ht->nslots) {
+    if (hashtable__increase(ht) != 0) {
+      return nullptr;
+    }
+  }
+  hashtable__place(ht, (hashtable__slot) {
+    keyref, valref, hash, 1
+  });
+  ht->nentries += 1;
+  return (void *) valref;
+}
+
+void *hashtable_remove(hashtable *ht, const void *keyref) {
+  size_t i = hashtable__search(ht, keyref, ht->hashfun(keyref));
+  if (i == ht->nslots) {
+    return nullptr;
+  }
+  const void *r = ht->slots[i].valref;
+  //  Retrait par décalage arrière : les entrées qui suivent et ne sont pas
+  //    dans leur case de départ se rapprochent d'une case.
+  size_t mask = ht->nslots - 1;
+  size_t j = (i + 1) & mask;
+  while (ht->slots[j].dist > 1) {
+    ht->slots[i] = ht->slots[j];
+    ht->slots[i].dist -= 1;
+    i = j;
+    j = (j + 1) & mask;
+  }
+  ht->slots[i].dist = 0;
+  ht->nentries -= 1;
+  return (void *) r;
+}
+
+void *hashtable_search(hashtable *ht, const void *keyref) {
+  size_t i = hashtable__search(ht, keyref, ht->hashfun(keyref));
+  return i == ht->nslots ? nullptr : (void *) ht->slots[i].valref;
+}
+
+#if defined HASHTABLE_EXT && defined WANT_HASHTABLE_EXT
+
+//  Pour cette implantation, le composant maxlen du bilan est la plus grande
+//    longueur de sondage d'une clé présente (le nombre de cases examinées pour
+//    la trouver), postheo l'estimation de Knuth (1 + 1 / (1 - r)) / 2 de la
+//    longueur moyenne de sondage d'une recherche positive pour le taux de
+//    remplissage courant r et poscurr la longueur moyenne de sondage des clés
+//    présentes.
+void hashtable_get_stats(hashtable *ht,
+    struct hashtable_stats *htsptr) {
+  size_t m = ht->nslots;
+  size_t g = 0;
+  double s = 0.0;
+  for (size_t k = 0; k < m; ++k) {
+    size_t f = ht->slots[k].dist;
+    if (f > g) {
+      g = f;
+    }
+    s += (double) f;
+  }
+  size_t n = ht->nentries;
+  double r = (double) n / (double) m;
+  *htsptr = (struct hashtable_stats) {
+    .nslots = m,
+    .nentries = n,
+    .lfmax = ht->lfmax,
+    .lfcurr = r,
+    .maxlen = g,
+    .postheo = (n == 0 ? 0.0 : (1.0 + 1.0 / (1.0 - r)) / 2.0),
+    .poscurr = s / (double) n,
+  };
+}
+
+#define P_TITLE(textstream, name) \
+  fprintf(textstream, "--- Info: %s\n", name)
+#define P_VALUE(textstream, name, format, value) \
+  fprintf(textstream, "%16s\t" format "\n", name, value)
+
+int hashtable_fprint_stats(hashtable *ht, FILE *textstream) {
+  struct hashtable_stats hts;
+  hashtable_get_stats(ht, &hts);
+  return 0 > P_TITLE(textstream, "Hashtable stats")
+    || 0 > P_VALUE(textstream, "n.slots", "%zu", hts.nslots)
+    || 0 > P_VALUE(textstream, "n.entries", "%zu", hts.nentries)
+    || 0 > P_VALUE(textstream, "load.fact.max", "%lf", hts.lfmax)
+    || 0 > P_VALUE(textstream, "load.fact.curr", "%lf", hts.lfcurr)
+    || 0 > P_VALUE(textstream, "max.len", "%zu", hts.maxlen)
+    || 0 > P_VALUE(textstream, "pos.theo", "%lf", hts.postheo)
+    || 0 > P_VALUE(textstream, "pos.curr", "%lf", hts.poscurr);
+}
+
+#endif
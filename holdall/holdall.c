@@ -1,31 +1,41 @@
 //  holdall.c : partie implantation du module holdall.
 
+#include <stdint.h>
 #include "holdall.h"
 
-typedef struct choldall choldall;
+//  HOLDALL__INITIAL_CAPACITY : capacité du tableau des références à sa
+//    première allocation.
+#define HOLDALL__INITIAL_CAPACITY 16
 
-struct choldall {
-  void *ref;
-  choldall *next;
-};
+//  struct holdall, holdall : les count références insérées sont mémorisées,
+//    dans l'ordre de leur insertion, dans le tableau dynamique refs de
+//    capacité capacity. Les parcours se font dans l'ordre croissant des
+//    indices si la macroconstante HOLDALL_PUT_TAIL est définie, dans l'ordre
+//    décroissant sinon, ce qui reproduit une insertion en queue ou en tête.
 
 struct holdall {
-  choldall *head;
-#if defined HOLDALL_PUT_TAIL
-  choldall **tailptr;
-#endif
+  void **refs;
+  size_t capacity;
   size_t count;
 };
 
+//  holdall__at : renvoie la k-ième référence, dans l'ordre d'itération, du
+//    fourretout associé à ha, 0 <= k < ha->count.
+static inline void *holdall__at(const holdall *ha, size_t k) {
+#if defined HOLDALL_PUT_TAIL
+  return ha->refs[k];
+#else
+  return ha->refs[ha->count - 1 - k];
+#endif
+}
+
 holdall *holdall_empty() {
   holdall *ha = malloc(sizeof *ha);
   if (ha == nullptr) {
     return nullptr;
   }
-  ha->head = nullptr;
-#if defined HOLDALL_PUT_TAIL
-  ha->tailptr = &ha->head;
-#endif
+  ha->refs = nullptr;
+  ha->capacity = 0;
   ha->count = 0;
   return ha;
 }
@@ -34,30 +44,26 @@ void holdall_dispose(holdall **haptr) {
   if (*haptr == nullptr) {
     return;
   }
-  choldall *p = (*haptr)->head;
-  while (p != nullptr) {
-    choldall *t = p;
-    p = p->next;
-    free(t);
-  }
+  free((*haptr)->refs);
   free(*haptr);
   *haptr = nullptr;
 }
 
 int holdall_put(holdall *ha, void *ref) {
-  choldall *p = malloc(sizeof *p);
-  if (p == nullptr) {
-    return -1;
+  if (ha->count == ha->capacity) {
+    size_t c = ha->capacity == 0 ? HOLDALL__INITIAL_CAPACITY
+        : 2 * ha->capacity;
+    if (c > SIZE_MAX / sizeof *ha->refs) {
+      return -1;
+    }
+    void **a = realloc(ha->refs, c * sizeof *a);
+    if (a == nullptr) {
+      return -1;
+    }
+    ha->refs = a;
+    ha->capacity = c;
   }
-  p->ref = ref;
-#if defined HOLDALL_PUT_TAIL
-  p->next = nullptr;
-  *ha->tailptr = p;
-  ha->tailptr = &p->next;
-#else
-  p->next = ha->head;
-  ha->head = p;
-#endif
+  ha->refs[ha->count] = ref;
   ha->count += 1;
   return 0;
 }
@@ -68,8 +74,9 @@ size_t holdall_count(holdall *ha) {
 
 int holdall_apply(holdall *ha,
     int (*fun)(void *)) {
-  for (const choldall *p = ha->head; p != nullptr; p = p->next) {
-    int r = fun(p->ref);
+  for (size_t k = 0; k < ha->count; ++k) {
+    void *ref = holdall__at(ha, k);
+    int r = fun(ref);
     if (r != 0) {
       return r;
     }
@@ -80,8 +87,9 @@ int holdall_apply(holdall *ha,
 int holdall_apply_context(holdall *ha,
     void *context, void *(*fun1)(void *context, void *ptr),
     int (*fun2)(void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != nullptr; p = p->next) {
-    int r = fun2(p->ref, fun1(context, p->ref));
+  for (size_t k = 0; k < ha->count; ++k) {
+    void *ref = holdall__at(ha, k);
+    int r = fun2(ref, fun1(context, ref));
     if (r != 0) {
       return r;
     }
@@ -92,8 +100,9 @@ int holdall_apply_context(holdall *ha,
 int holdall_apply_context2(holdall *ha,
     void *context1, void *(*fun1)(void *context1, void *ptr),
     void *context2, int (*fun2)(void *context2, void *ptr, void *resultfun1)) {
-  for (const choldall *p = ha->head; p != nullptr; p = p->next) {
-    int r = fun2(context2, p->ref, fun1(context1, p->ref));
+  for (size_t k = 0; k < ha->count; ++k) {
+    void *ref = holdall__at(ha, k);
+    int r = fun2(context2, ref, fun1(context1, ref));
     if (r != 0) {
       return r;
     }
@@ -103,33 +112,33 @@ int holdall_apply_context2(holdall *ha,
 
 #if defined HOLDALL_EXT && defined WANT_HOLDALL_EXT
 
-void **holdall_to_array(holdall *ha) {
-  if (ha == nullptr || ha->count == 0) {
-    return nullptr;
-  }
-  void **array = (void **) malloc(ha->count * sizeof(void *));
-  if (array == nullptr) {
-    return nullptr;
-  }
-  choldall *p = ha->head;
-  size_t i = 0;
-  while (p != nullptr && i < ha->count) {
-    array[i] = p->ref;
-    p = p->next;
-    i++;
+#if !defined HOLDALL_PUT_TAIL
+
+//  holdall__reverse : renverse l'ordre des count références du tableau refs.
+static void holdall__reverse(void **refs, size_t count) {
+  for (size_t i = 0, j = count; i + 1 < j; ++i, --j) {
+    void *t = refs[i];
+    refs[i] = refs[j - 1];
+    refs[j - 1] = t;
   }
-  return array;
 }
 
+#endif
+
+//  Le tri se fait sur place. En l'absence de HOLDALL_PUT_TAIL, le tableau est
+//    parcouru à rebours par l'itération : il est renversé après le tri afin
+//    que l'ordre d'itération soit l'ordre croissant. qsort n'étant pas
+//    stable, l'ordre des références égales n'est pas spécifié.
 void holdall_sort(holdall *ha, int (*cmp)(const void *, const void *)) {
-  void **array = holdall_to_array(ha);
-  qsort(array, ha->count, sizeof(void *), cmp);
-  choldall *p = ha->head;
-  for (size_t i = 0; i < ha->count; i++) {
-    p->ref = array[i];
-    p = p->next;
+  if (ha->count == 0) {
+    return;
   }
-  free(array);
+#if defined HOLDALL_PUT_TAIL
+  qsort(ha->refs, ha->count, sizeof *ha->refs, cmp);
+#else
+  qsort(ha->refs, ha->count, sizeof *ha->refs, cmp);
+  holdall__reverse(ha->refs, ha->count);
+#endif
 }
 
 #endif
@@ -1,17 +1,18 @@
 //  holdall_ip.h : précisions sur l'implantation du module holdall.
 
-//  L'implantation recoure à une liste dynamique simplement chainée des
-//    références. Si la macroconstante HOLDALL_PUT_TAIL est définie, la fonction
-//    holdall_put insère les références en queue ; dans le cas contraire, elle
-//    les insère en tête.
+//  L'implantation recoure à un tableau dynamique des références, rangées dans
+//    l'ordre de leur insertion. Si la macroconstante HOLDALL_PUT_TAIL est
+//    définie, les parcours suivent cet ordre, comme si la fonction
+//    holdall_put insérait les références en queue ; dans le cas contraire, ils
+//    le suivent à rebours, comme si elle les insérait en tête.
 
 //  Lorsqu'ils ne sont pas constants, les couts sont exprimés en fonction du
 //    nombre nombre d'insertions effectuées avec succès dans le fourretout
 //    depuis sa création.
 
 //  holdall_empty : temps constant ; espace constant.
-//  holdall_dispose : temps linéaire ; espace constant.
-//  holdall_put : temps constant ; espace constant.
+//  holdall_dispose : temps constant ; espace constant.
+//  holdall_put : temps amorti constant ; espace constant.
 //  holdall_count : temps constant ; espace constant.
 //  holdall_apply, holdall_apply_context, holdall_apply_context2, sans compter
 //    ni le temps ni l'espace nécessaire à l'exécution des fonctions fun, fun1
@@ -19,5 +20,5 @@
 
 #define HOLDALL_EXT
 
-//  holdall_sort : temps en O(N log N) ; espace en O(N) (N étant le nombre d'
-//    éléménts)
+//  holdall_sort : temps en O(N log N) ; tri sur place, sans autre espace que
+//    celui qu'utilise qsort (N étant le nombre d'éléments)
@@ -1,21 +1,50 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "jdis.h"
+#include "arena.h"
+#include "bitmatrix.h"
+#include "corpusindex.h"
 #include "hashtable.h"
-#include "holdall.h"
+#include "lexicon.h"
+#include "lsh.h"
+#include "minhash.h"
+#include "outbuf.h"
+#include "postings.h"
+#include "simjoin.h"
+#include "strsort.h"
+#include "threadpool.h"
+#include "tokenizer.h"
+#include "wordcache.h"
+#include "wordset.h"
+#include <fcntl.h>
+#include <locale.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <stdbool.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-//  compare_strings_for_qsort : fonction de comparaison pour qsort (utilisée via
-//    holdall_sort). Compare deux chaînes de caractères pointées indirectement
-//    par a et b (qui sont des pointeurs vers des char*).
-//    Utilise strcoll pour une comparaison sensible à la locale.
-int compare_strings_for_qsort(const void *a, const void *b) {
-  const char *s1 = *(const char **) a;
-  const char *s2 = *(const char **) b;
-  return strcoll(s1, s2);
-}
+//  JDIS_BITSET_MAX_BYTES : taille en octets au-delà de laquelle la matrice
+//    binaire fichiers × mots n'est pas construite.
+#define JDIS_BITSET_MAX_BYTES ((size_t) 256 << 20)
+
+//  JDIS_BITSET_ROW_BLOCK : nombre de lignes de la matrice des intersections
+//    calculées puis affichées ensemble par le moteur à matrice binaire.
+#define JDIS_BITSET_ROW_BLOCK 16
+
+//  JDIS_BITSET_COST_FACTOR, JDIS_INDEX_COST_FACTOR, JDIS_JOIN_COST_FACTOR :
+//    coûts d'une opération de la matrice binaire, d'un incrément de l'index
+//    inversé et d'une rencontre de la jointure, en étapes de la fusion. Les
+//    mots de 64 bits de la matrice sont traités par paquets ; un incrément
+//    est une écriture à une adresse quelconque de la ligne des compteurs ;
+//    une rencontre met à jour l'état d'un candidat, et le coût de la
+//    vérification des candidats s'y ajoute.
+#define JDIS_BITSET_COST_FACTOR 0.25
+#define JDIS_INDEX_COST_FACTOR 2.0
+#define JDIS_JOIN_COST_FACTOR 8.0
 
 //  compare_strings_for_hashtable : fonction de comparaison pour la table de
 //    hachage. Compare deux chaînes de caractères pointées par a et b.
@@ -38,85 +67,195 @@ size_t hash_string(const void *key) {
   return hash;
 }
 
-//  free_holdall_word : fonction utilitaire pour holdall_apply. Libère la
-// mémoire
-//    allouée pour une chaîne de caractères (mot) pointée par word_ref.
-//    Renvoie toujours 0 pour indiquer à holdall_apply de continuer.
-static int free_holdall_word(void *word_ref) {
-  free(word_ref);
-  return 0;
+//  compare_word_ids : fonction de comparaison pour qsort des identifiants ou
+//    des rangs de mots. Compare les deux entiers pointés par a et b.
+static int compare_word_ids(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *) a;
+  uint32_t y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
 }
 
-void jdis_free_holdall_content(holdall *ha) {
-  if (ha == nullptr) {
-    return;
+//  word_sink_fun : type des fonctions auxquelles read_words transmet les mots
+//    d'un fichier au fur et à mesure de leur lecture. Une telle fonction reçoit
+//    son contexte sink_context et le mot word, déjà tronqué si nécessaire.
+//    Elle renvoie 0 en cas de succès, -1 en cas d'erreur d'allocation.
+typedef int (*word_sink_fun)(void *sink_context, const char *word);
+
+//  JDIS_WORD_CHUNK : lorsque la longueur des mots est limitée, un mot de plus
+//    de JDIS_WORD_CHUNK octets est traité comme une suite de mots de
+//    JDIS_WORD_CHUNK octets, le dernier étant éventuellement plus court.
+#define JDIS_WORD_CHUNK 255
+
+//  read_words_context_t : structure de contexte de la fonction emit_word.
+//    Membres :
+//      initial_letters_limit : nombre de lettres initiales conservées
+//                              (0 = pas de limite).
+//      filename_for_log : nom du fichier, pour les messages.
+//      diag : flot des messages d'erreur et d'avertissement.
+//      truncated : flot sur lequel sont écrits les mots tronqués, chacun
+//                  suivi d'un caractère nul, ou nullptr.
+//      add_word, sink_context : fonction à laquelle sont transmis les mots et
+//                               son contexte.
+//      buffer : tampon, de capacité capacity, de la chaîne transmise.
+typedef struct {
+  int initial_letters_limit;
+  const char *filename_for_log;
+  FILE *diag;
+  FILE *truncated;
+  word_sink_fun add_word;
+  void *sink_context;
+  char *buffer;
+  size_t capacity;
+} read_words_context_t;
+
+//  print_truncation_warning : écrit sur le flot diag l'avertissement signalant
+//    que le mot word du fichier filename est tronqué à ses limit premiers
+//    octets.
+static void print_truncation_warning(FILE *diag, const char *word, int limit,
+    const char *filename) {
+  fprintf(diag,
+      "Warning: Word '%s...' truncated to '%.*s' from file '%s' due to -i %d limit.\n",
+      word, limit, word, filename, limit);
+}
+
+//  emit_word : fonction de type tokenizer_fun. Recopie dans le tampon du
+//    contexte les octets de la tranche de length octets débutant à l'adresse
+//    word qui précèdent son éventuel premier caractère nul, tronque si
+//    nécessaire la chaîne obtenue selon la limite du contexte, en le
+//    signalant et en l'écrivant sur le flot des mots tronqués du contexte
+//    s'il existe, puis la transmet à la fonction du contexte. Renvoie 1 en cas
+//    d'erreur, 0 sinon.
+static int emit_word(void *context, const char *word, size_t length) {
+  read_words_context_t *ctx = context;
+  const char *nul = memchr(word, '\0', length);
+  if (nul != nullptr) {
+    length = (size_t) (nul - word);
   }
-  holdall_apply(ha, free_holdall_word);
-}
-
-//  process_and_add_words : traite un mot, le tronque si nécessaire selon
-//    initial_letters_limit, et l'ajoute au fourretout words_ha s'il n'est
-//    pas déjà présent dans la table de hachage temp_uniqueness_ht (assurant
-//    l'unicité). Met à jour temp_uniqueness_ht.
-//    Renvoie 0 en cas de succès, -1 en cas d'erreur d'allocation.
-static int process_and_add_words(
-    const char *word_to_process_original,
-    int initial_letters_limit,
-    holdall *words_ha,
-    hashtable *temp_uniqueness_ht,
-    char *processed_word_buffer_for_truncation,
-    const char *filename_for_log) {
-  const char *word_to_add = word_to_process_original;
-  if (initial_letters_limit > 0
-      && (int) strlen(word_to_process_original) > initial_letters_limit) {
-    strncpy(processed_word_buffer_for_truncation, word_to_process_original,
-        (size_t) initial_letters_limit);
-    processed_word_buffer_for_truncation[initial_letters_limit] = '\0';
-    word_to_add = processed_word_buffer_for_truncation;
-    fprintf(stderr,
-        "Warning: Word '%s...' truncated to '%s' from file '%s' due to -i %d limit.\n",
-        word_to_process_original,
-        processed_word_buffer_for_truncation,
-        filename_for_log,
-        initial_letters_limit);
-  }
-  if (hashtable_search(temp_uniqueness_ht, word_to_add) == nullptr) {
-    char *word_copy = strdup(word_to_add);
-    if (word_copy == nullptr) {
-      fprintf(stderr, "Error: strdup failed for word '%s' in file '%s'\n",
-          word_to_add, filename_for_log);
+  if (length + 1 > ctx->capacity) {
+    size_t c = ctx->capacity == 0 ? 256 : ctx->capacity;
+    while (c < length + 1) {
+      c *= 2;
+    }
+    char *b = realloc(ctx->buffer, c);
+    if (b == nullptr) {
+      fprintf(ctx->diag, "Error: realloc failed for word buffer in file '%s'\n",
+          ctx->filename_for_log);
+      return 1;
+    }
+    ctx->buffer = b;
+    ctx->capacity = c;
+  }
+  memcpy(ctx->buffer, word, length);
+  ctx->buffer[length] = '\0';
+  int limit = ctx->initial_letters_limit;
+  if (limit > 0 && length > (size_t) limit) {
+    print_truncation_warning(ctx->diag, ctx->buffer, limit,
+        ctx->filename_for_log);
+    if (ctx->truncated != nullptr) {
+      fwrite(ctx->buffer, 1, length + 1, ctx->truncated);
+    }
+    ctx->buffer[limit] = '\0';
+  }
+  return ctx->add_word(ctx->sink_context, ctx->buffer) == 0 ? 0 : 1;
+}
+
+//  read_words : lit le fichier filename et transmet chacun de ses mots, dans
+//    l'ordre de lecture et tronqué si nécessaire selon initial_letters_limit,
+//    à add_word avec le contexte sink_context. La ponctuation est traitée
+//    comme un séparateur si punctuation_as_space vaut true. Les messages
+//    d'erreur et d'avertissement sont écrits sur le flot diag, les mots
+//    tronqués sur le flot truncated s'il ne vaut pas nullptr.
+//    Renvoie 0 en cas de succès, -1 si le fichier ne peut être ouvert ou en
+//    cas d'erreur d'allocation.
+static int read_words(const char *filename, int initial_letters_limit,
+    bool punctuation_as_space, FILE *diag, FILE *truncated,
+    word_sink_fun add_word, void *sink_context) {
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) {
+    fprintf(diag, "Error: unable to open file '%s'\n", filename);
+    return -1;
+  }
+  read_words_context_t ctx = {
+    initial_letters_limit, filename, diag, truncated, add_word, sink_context,
+    nullptr, 0
+  };
+  int r = tokenizer_scan(fd, punctuation_as_space,
+      initial_letters_limit > 0 ? JDIS_WORD_CHUNK : 0, emit_word, &ctx);
+  close(fd);
+  free(ctx.buffer);
+  if (r != 0) {
+    if (r < 0) {
+      fprintf(diag, "Error: tokenizer failed to allocate memory for file '%s'\n",
+          filename);
+    }
+    fprintf(diag, "An error occurred during word processing for file '%s'.\n",
+        filename);
+    return -1;
+  }
+  return 0;
+}
+
+//  intern_sink_context_t : structure de contexte de la fonction
+//    intern_word_sink.
+//    Membres :
+//      words_ws : ensemble des identifiants des mots du fichier.
+//      lx : dictionnaire partagé par tous les fichiers du corpus.
+//      signature : signature MinHash du fichier, ou nullptr.
+//      temp_uniqueness_ht : table de hachage des mots déjà rencontrés dans le
+//                           fichier, dont les clés sont les copies qu'en
+//                           conserve lx.
+//      filename_for_log : nom du fichier, pour les messages d'erreur.
+//      diag : flot des messages d'erreur.
+typedef struct {
+  wordset *words_ws;
+  lexicon *lx;
+  minhash *signature;
+  hashtable *temp_uniqueness_ht;
+  const char *filename_for_log;
+  FILE *diag;
+} intern_sink_context_t;
+
+//  intern_word_sink : fonction de type word_sink_fun. Si word n'est pas
+//    présent dans la table de hachage du contexte (assurant l'unicité),
+//    l'interne dans le dictionnaire, ajoute son identifiant à l'ensemble et
+//    met à jour la signature MinHash si elle existe.
+static int intern_word_sink(void *sink_context, const char *word) {
+  intern_sink_context_t *ctx = sink_context;
+  if (hashtable_search(ctx->temp_uniqueness_ht, word) == nullptr) {
+    uint32_t id = lexicon_intern(ctx->lx, word);
+    if (id == LEXICON_NOID) {
+      fprintf(ctx->diag,
+          "Error: lexicon_intern failed for word '%s' in file '%s'\n",
+          word, ctx->filename_for_log);
       return -1;
     }
-    if (hashtable_add(temp_uniqueness_ht, word_copy, (void *) 1) == nullptr) {
-      fprintf(stderr,
+    const char *interned_word = lexicon_word(ctx->lx, id);
+    if (hashtable_add(ctx->temp_uniqueness_ht, interned_word, (void *) 1)
+        == nullptr) {
+      fprintf(ctx->diag,
           "Error: hashtable_add failed for word '%s' in file '%s'\n",
-          word_copy, filename_for_log);
-      free(word_copy);
+          interned_word, ctx->filename_for_log);
       return -1;
     }
-    if (holdall_put(words_ha, word_copy) != 0) {
-      fprintf(stderr, "Error: holdall_put failed for word '%s' in file '%s'\n",
-          word_copy, filename_for_log);
-      hashtable_remove(temp_uniqueness_ht, word_copy);
-      free(word_copy);
+    if (wordset_put(ctx->words_ws, id) != 0) {
+      fprintf(ctx->diag,
+          "Error: wordset_put failed for word '%s' in file '%s'\n",
+          interned_word, ctx->filename_for_log);
+      hashtable_remove(ctx->temp_uniqueness_ht, interned_word);
       return -1;
     }
+    if (ctx->signature != nullptr) {
+      minhash_add(ctx->signature, interned_word);
+    }
   }
   return 0;
 }
 
-holdall *get_words(const char *filename, int initial_letters_limit,
-    bool punctuation_as_space) {
-  FILE *file = nullptr;
-  file = fopen(filename, "r");
-  if (file == nullptr) {
-    fprintf(stderr, "Error: unable to open file '%s'\n", filename);
-    return nullptr;
-  }
-  holdall *words_ha = holdall_empty();
-  if (words_ha == nullptr) {
-    fclose(file);
-    fprintf(stderr, "Error: Failed to allocate holdall for file '%s'\n",
+wordset *get_words(const char *filename, lexicon *lx, minhash *signature,
+    int initial_letters_limit, bool punctuation_as_space) {
+  wordset *words_ws = wordset_empty();
+  if (words_ws == nullptr) {
+    fprintf(stderr, "Error: Failed to allocate wordset for file '%s'\n",
         filename);
     return nullptr;
   }
@@ -124,114 +263,537 @@ holdall *get_words(const char *filename, int initial_letters_limit,
       hash_string,
       0.75);
   if (temp_uniqueness_ht == nullptr) {
-    fclose(file);
-    holdall_dispose(&words_ha);
+    wordset_dispose(&words_ws);
     fprintf(stderr, "Error: Failed to allocate temp hashtable for file '%s'\n",
         filename);
     return nullptr;
   }
-  char static_word_buffer[256];
-  char *dynamic_word_buffer = nullptr;
-  size_t dynamic_buffer_capacity = 0;
-  char *current_word_assembly_buffer = nullptr;
-  char processed_word_buffer[256];
-  int char_code;
-  int word_idx = 0;
-  while ((char_code = fgetc(file)) != EOF) {
-    char current_char = (char) char_code;
-    bool is_delimiter = isspace(current_char)
-        || (punctuation_as_space && ispunct(current_char));
-    if (!is_delimiter) {
-      if (initial_letters_limit == 0) {
-        if (dynamic_word_buffer == nullptr) {
-          dynamic_buffer_capacity = 256;
-          dynamic_word_buffer = malloc(dynamic_buffer_capacity);
-          if (dynamic_word_buffer == nullptr) {
-            fprintf(stderr,
-                "Error: malloc failed for dynamic_word_buffer in file '%s'\n",
-                filename);
-            goto cleanup_error;
-          }
-        } else if ((size_t) word_idx >= dynamic_buffer_capacity - 1) {
-          dynamic_buffer_capacity *= 2;
-          char *temp_realloc = realloc(dynamic_word_buffer,
-              dynamic_buffer_capacity);
-          if (temp_realloc == nullptr) {
-            fprintf(stderr,
-                "Error: realloc failed for dynamic_word_buffer in file '%s'\n",
-                filename);
-            goto cleanup_error;
-          }
-          dynamic_word_buffer = temp_realloc;
-        }
-        dynamic_word_buffer[word_idx++] = current_char;
-        current_word_assembly_buffer = dynamic_word_buffer;
-      } else {
-        if ((size_t) word_idx < sizeof(static_word_buffer) - 1) {
-          static_word_buffer[word_idx++] = current_char;
-        } else {
-          static_word_buffer[word_idx] = '\0';
-          current_word_assembly_buffer = static_word_buffer;
-          if (process_and_add_words(current_word_assembly_buffer,
-              initial_letters_limit, words_ha,
-              temp_uniqueness_ht, processed_word_buffer,
-              filename) != 0) {
-            goto cleanup_error;
-          }
-          word_idx = 0;
-          static_word_buffer[word_idx++] = current_char;
-        }
-        current_word_assembly_buffer = static_word_buffer;
-      }
-    } else {
-      if (word_idx > 0) {
-        current_word_assembly_buffer = (initial_letters_limit
-            == 0) ? dynamic_word_buffer : static_word_buffer;
-        current_word_assembly_buffer[word_idx] = '\0';
-        if (process_and_add_words(current_word_assembly_buffer,
-            initial_letters_limit, words_ha,
-            temp_uniqueness_ht, processed_word_buffer,
-            filename) != 0) {
-          goto cleanup_error;
-        }
-        word_idx = 0;
-      }
+  intern_sink_context_t sink_ctx = {
+    words_ws, lx, signature, temp_uniqueness_ht, filename, stderr
+  };
+  int r = read_words(filename, initial_letters_limit, punctuation_as_space,
+      stderr, nullptr, intern_word_sink, &sink_ctx);
+  hashtable_dispose(&temp_uniqueness_ht);
+  if (r != 0) {
+    wordset_dispose(&words_ws);
+    return nullptr;
+  }
+  wordset_sort(words_ws);
+  return words_ws;
+}
+
+//  INGEST_WINDOW_PER_THREAD : nombre de fichiers qu'un fil d'ingestion peut
+//    lire d'avance, au-delà du dernier fichier intégré par le fil principal.
+#define INGEST_WINDOW_PER_THREAD 4
+
+//  ingest_job_t : résultat de la lecture d'un fichier par un fil d'ingestion.
+//    Membres :
+//      words : tableau dynamique des copies des mots distincts du fichier,
+//              dans l'ordre de leur première occurrence.
+//      strings : arène dans laquelle sont rangées ces copies, ou nullptr si
+//                elles proviennent de l'entrée cached ou de l'index.
+//      cached : entrée du cache dont les mots sont tirés, ou nullptr.
+//      count : nombre de mots du tableau words.
+//      capacity : capacité du tableau words.
+//      diag_text : texte des messages d'erreur et d'avertissement émis
+//                  pendant la lecture, ou nullptr.
+//      diag_length : longueur de diag_text.
+//      truncated_text : mots tronqués pendant la lecture, chacun suivi d'un
+//                       caractère nul, ou nullptr. Ce sont eux, plutôt que le
+//                       texte des messages, qui sont mémorisés par le cache
+//                       et l'index : les avertissements sont ainsi reproduits
+//                       avec le nom sous lequel le fichier est désigné.
+//      truncated_length : longueur de truncated_text.
+//      status : 0 en cas de succès, -1 en cas d'erreur.
+//      done : indique si la lecture est achevée.
+typedef struct {
+  const char **words;
+  arena *strings;
+  wordcache_entry *cached;
+  size_t count;
+  size_t capacity;
+  char *diag_text;
+  size_t diag_length;
+  char *truncated_text;
+  size_t truncated_length;
+  int status;
+  bool done;
+} ingest_job_t;
+
+//  ingest_context_t : structure de contexte partagée par les fils
+//    d'ingestion et le fil principal. Les membres next, merged, abort et les
+//    membres done des travaux sont protégés par mutex ; cond signale toute
+//    modification de l'un d'eux.
+//    Membres :
+//      filenames, num_files : noms des fichiers à lire et leur nombre.
+//      signatures : signatures MinHash des fichiers, ou nullptr.
+//      initial_letters_limit, punctuation_as_space : options de lecture.
+//      cache : cache des mots distincts des fichiers, ou nullptr.
+//      index : index chargé, ou nullptr.
+//      records : informations sur la lecture des fichiers, ou nullptr.
+//      jobs : tableau des résultats de lecture, un par fichier.
+//      next : indice du prochain fichier à attribuer à un fil.
+//      merged : nombre de fichiers déjà intégrés par le fil principal.
+//      window : nombre de fichiers pouvant être lus d'avance.
+//      abort : indique que l'ingestion est abandonnée.
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  char **filenames;
+  size_t num_files;
+  minhash **signatures;
+  int initial_letters_limit;
+  bool punctuation_as_space;
+  wordcache *cache;
+  const corpusindex *index;
+  jdis_file_record *records;
+  ingest_job_t *jobs;
+  size_t next;
+  size_t merged;
+  size_t window;
+  bool abort;
+} ingest_context_t;
+
+//  collect_sink_context_t : structure de contexte de la fonction
+//    collect_word_sink.
+//    Membres :
+//      job : résultat de la lecture du fichier.
+//      temp_uniqueness_ht : table de hachage des mots déjà rencontrés dans le
+//                           fichier, dont les clés sont les copies de
+//                           job->words.
+//      signature : signature MinHash du fichier, ou nullptr.
+//      filename_for_log : nom du fichier, pour les messages d'erreur.
+//      diag : flot des messages d'erreur.
+typedef struct {
+  ingest_job_t *job;
+  hashtable *temp_uniqueness_ht;
+  minhash *signature;
+  const char *filename_for_log;
+  FILE *diag;
+} collect_sink_context_t;
+
+//  collect_word_sink : fonction de type word_sink_fun. Si word n'est pas
+//    présent dans la table de hachage du contexte (assurant l'unicité), en
+//    ajoute une copie au résultat de lecture et met à jour la signature
+//    MinHash si elle existe.
+static int collect_word_sink(void *sink_context, const char *word) {
+  collect_sink_context_t *ctx = sink_context;
+  if (hashtable_search(ctx->temp_uniqueness_ht, word) != nullptr) {
+    return 0;
+  }
+  ingest_job_t *job = ctx->job;
+  if (job->count == job->capacity) {
+    size_t c = job->capacity == 0 ? 256 : 2 * job->capacity;
+    const char **a = realloc(job->words, c * sizeof *a);
+    if (a == nullptr) {
+      fprintf(ctx->diag, "Error: realloc failed for word list in file '%s'\n",
+          ctx->filename_for_log);
+      return -1;
     }
+    job->words = a;
+    job->capacity = c;
+  }
+  char *word_copy = arena_strdup(job->strings, word);
+  if (word_copy == nullptr) {
+    fprintf(ctx->diag,
+        "Error: arena_strdup failed for word '%s' in file '%s'\n",
+        word, ctx->filename_for_log);
+    return -1;
   }
-  if (word_idx > 0) {
-    current_word_assembly_buffer = (initial_letters_limit
-        == 0) ? dynamic_word_buffer : static_word_buffer;
-    current_word_assembly_buffer[word_idx] = '\0';
-    if (process_and_add_words(current_word_assembly_buffer,
-        initial_letters_limit, words_ha,
-        temp_uniqueness_ht, processed_word_buffer,
-        filename) != 0) {
-      goto cleanup_error;
+  if (hashtable_add(ctx->temp_uniqueness_ht, word_copy, (void *) 1)
+      == nullptr) {
+    fprintf(ctx->diag,
+        "Error: hashtable_add failed for word '%s' in file '%s'\n",
+        word_copy, ctx->filename_for_log);
+    return -1;
+  }
+  job->words[job->count] = word_copy;
+  job->count += 1;
+  if (ctx->signature != nullptr) {
+    minhash_add(ctx->signature, word_copy);
+  }
+  return 0;
+}
+
+//  ingest_job_dispose : libère les copies des mots du résultat de lecture
+//    job et les messages qu'il contient.
+static void ingest_job_dispose(ingest_job_t *job) {
+  arena_dispose(&job->strings);
+  wordcache_entry_dispose(&job->cached);
+  free(job->words);
+  job->words = nullptr;
+  job->count = 0;
+  job->capacity = 0;
+  free(job->diag_text);
+  job->diag_text = nullptr;
+  free(job->truncated_text);
+  job->truncated_text = nullptr;
+}
+
+//  ingest_fill_job : tente de remplir le travail job, vide, du contexte ctx
+//    pour le fichier filename avec les count mots qui se suivent à partir de
+//    l'adresse words, chacun terminé par un caractère nul, une copie des
+//    truncated_length octets de la zone pointée par truncated, mots tronqués
+//    lors de la lecture, et les avertissements correspondants, et de mettre à
+//    jour la signature signature si elle ne vaut pas nullptr. Les mots ne sont
+//    pas recopiés. Renvoie 0 en cas de succès, -1 en cas d'erreur
+//    d'allocation ; le travail est alors laissé vide.
+static int ingest_fill_job(ingest_context_t *ctx, ingest_job_t *job,
+    const char *filename, const char *words, size_t count,
+    const char *truncated, size_t truncated_length, minhash *signature) {
+  const char **a = malloc((count + 1) * sizeof *a);
+  char *truncated_text = malloc(truncated_length + 1);
+  char *diag_text = nullptr;
+  size_t diag_length = 0;
+  FILE *diag = open_memstream(&diag_text, &diag_length);
+  if (a == nullptr || truncated_text == nullptr || diag == nullptr) {
+    if (diag != nullptr) {
+      fclose(diag);
     }
+    free(diag_text);
+    free(a);
+    free(truncated_text);
+    return -1;
+  }
+  for (size_t k = 0; k < truncated_length;
+      k += strlen(truncated + k) + 1) {
+    print_truncation_warning(diag, truncated + k, ctx->initial_letters_limit,
+        filename);
   }
-  fclose(file);
-  if (dynamic_word_buffer != nullptr) {
-    free(dynamic_word_buffer);
+  if (fclose(diag) != 0) {
+    free(diag_text);
+    free(a);
+    free(truncated_text);
+    return -1;
   }
-  hashtable_dispose(&temp_uniqueness_ht);
-  return words_ha;
-cleanup_error:
-  if (file != nullptr) {
-    fclose(file);
+  for (size_t k = 0; k < count; ++k) {
+    a[k] = words;
+    words += strlen(words) + 1;
+    if (signature != nullptr) {
+      minhash_add(signature, a[k]);
+    }
+  }
+  memcpy(truncated_text, truncated, truncated_length);
+  truncated_text[truncated_length] = '\0';
+  job->words = a;
+  job->count = count;
+  job->capacity = count;
+  job->diag_text = diag_text;
+  job->diag_length = diag_length;
+  job->truncated_text = truncated_text;
+  job->truncated_length = truncated_length;
+  job->status = 0;
+  return 0;
+}
+
+//  ingest_load_cached : tente de remplir le travail job, vide, à partir de
+//    l'entrée du cache du contexte ctx pour le fichier filename d'identité
+//    courante *st, à la manière de ingest_fill_job. Renvoie 0 en cas de
+//    succès, -1 si l'entrée est absente, périmée ou invalide ou en cas
+//    d'erreur d'allocation ; le travail est alors laissé vide.
+static int ingest_load_cached(ingest_context_t *ctx, ingest_job_t *job,
+    const char *filename, const struct stat *st, minhash *signature) {
+  wordcache_entry *e = wordcache_load(ctx->cache, filename, st,
+      ctx->initial_letters_limit, ctx->punctuation_as_space);
+  if (e == nullptr) {
+    return -1;
+  }
+  size_t truncated_length;
+  const char *truncated = wordcache_entry_diag(e, &truncated_length);
+  if (ingest_fill_job(ctx, job, filename, wordcache_entry_words(e),
+      wordcache_entry_count(e), truncated, truncated_length, signature) != 0) {
+    wordcache_entry_dispose(&e);
+    return -1;
+  }
+  job->cached = e;
+  return 0;
+}
+
+//  ingest_load_indexed : tente de remplir le travail job, vide, à partir de
+//    l'index du contexte ctx pour le fichier filename d'identité courante
+//    *st, à la manière de ingest_fill_job. Renvoie le rang du fichier dans
+//    l'index en cas de succès, CORPUSINDEX_NONE s'il n'y figure pas ou en
+//    cas d'erreur d'allocation ; le travail est alors laissé vide.
+static size_t ingest_load_indexed(ingest_context_t *ctx, ingest_job_t *job,
+    const char *filename, const struct stat *st, minhash *signature) {
+  size_t slot = corpusindex_find(ctx->index, filename, st);
+  if (slot == CORPUSINDEX_NONE) {
+    return CORPUSINDEX_NONE;
   }
-  if (dynamic_word_buffer != nullptr) {
-    free(dynamic_word_buffer);
+  size_t count;
+  const char *words = corpusindex_words(ctx->index, slot, &count);
+  size_t truncated_length;
+  const char *truncated = corpusindex_diag(ctx->index, slot,
+      &truncated_length);
+  if (ingest_fill_job(ctx, job, filename, words, count, truncated,
+      truncated_length, signature) != 0) {
+    return CORPUSINDEX_NONE;
   }
-  if (words_ha != nullptr) {
-    jdis_free_holdall_content(words_ha);
-    holdall_dispose(&words_ha);
+  return slot;
+}
+
+//  ingest_read_file : lit le fichier d'indice i du contexte ctx et en range
+//    les mots distincts ainsi que les messages dans le travail correspondant.
+//    Si le fichier est un fichier ordinaire, ses mots sont tirés de l'index
+//    du contexte s'il y figure ; sinon, si le contexte dispose d'un cache, ils
+//    sont tirés de son entrée si elle est valide, l'entrée étant sinon écrite
+//    après une lecture réussie. Ne modifie que ce travail, les informations
+//    sur la lecture du fichier et sa signature.
+static void ingest_read_file(ingest_context_t *ctx, size_t i) {
+  ingest_job_t *job = &ctx->jobs[i];
+  const char *filename = ctx->filenames[i];
+  minhash *signature = ctx->signatures == nullptr ? nullptr
+      : ctx->signatures[i];
+  struct stat st;
+  bool regular = (ctx->cache != nullptr || ctx->records != nullptr)
+      && stat(filename, &st) == 0 && S_ISREG(st.st_mode);
+  if (ctx->records != nullptr && regular) {
+    ctx->records[i].indexable = true;
+    ctx->records[i].st = st;
+  }
+  if (regular && ctx->index != nullptr) {
+    size_t slot = ingest_load_indexed(ctx, job, filename, &st, signature);
+    if (slot != CORPUSINDEX_NONE) {
+      ctx->records[i].slot = slot;
+      return;
+    }
+  }
+  bool cacheable = regular && ctx->cache != nullptr;
+  if (cacheable
+      && ingest_load_cached(ctx, job, filename, &st, signature) == 0) {
+    return;
+  }
+  FILE *diag = open_memstream(&job->diag_text, &job->diag_length);
+  FILE *truncated = open_memstream(&job->truncated_text,
+      &job->truncated_length);
+  if (diag == nullptr || truncated == nullptr) {
+    if (diag != nullptr) {
+      fclose(diag);
+    }
+    job->status = -1;
+    return;
   }
-  if (temp_uniqueness_ht != nullptr) {
+  job->strings = arena_empty();
+  hashtable *temp_uniqueness_ht = hashtable_empty(compare_strings_for_hashtable,
+      hash_string, 0.75);
+  if (job->strings == nullptr || temp_uniqueness_ht == nullptr) {
+    fprintf(diag, "Error: Failed to allocate temp hashtable for file '%s'\n",
+        filename);
     hashtable_dispose(&temp_uniqueness_ht);
+    job->status = -1;
+  } else {
+    collect_sink_context_t sink_ctx = {
+      job, temp_uniqueness_ht, signature, filename, diag
+    };
+    job->status = read_words(filename, ctx->initial_letters_limit,
+        ctx->punctuation_as_space, diag, truncated, collect_word_sink,
+        &sink_ctx);
+    hashtable_dispose(&temp_uniqueness_ht);
+  }
+  fclose(diag);
+  if (fclose(truncated) != 0) {
+    job->status = -1;
+  }
+  if (cacheable && job->status == 0) {
+    wordcache_store(ctx->cache, filename, &st, ctx->initial_letters_limit,
+        ctx->punctuation_as_space, job->words, job->count,
+        job->truncated_text, job->truncated_length);
+  }
+}
+
+//  ingest_worker : fonction de travail d'un fil d'ingestion. Tant que
+//    l'ingestion n'est pas abandonnée, s'attribue le prochain fichier à lire,
+//    pourvu qu'il soit dans la fenêtre de lecture d'avance, et le lit.
+static void ingest_worker(void *context, size_t worker) {
+  (void) worker;
+  ingest_context_t *ctx = context;
+  pthread_mutex_lock(&ctx->mutex);
+  for (;;) {
+    while (!ctx->abort && ctx->next < ctx->num_files
+        && ctx->next >= ctx->merged + ctx->window) {
+      pthread_cond_wait(&ctx->cond, &ctx->mutex);
+    }
+    if (ctx->abort || ctx->next >= ctx->num_files) {
+      break;
+    }
+    size_t i = ctx->next;
+    ctx->next += 1;
+    pthread_mutex_unlock(&ctx->mutex);
+    ingest_read_file(ctx, i);
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->jobs[i].done = true;
+    pthread_cond_broadcast(&ctx->cond);
+  }
+  pthread_mutex_unlock(&ctx->mutex);
+}
+
+//  ingest_merge_file : interne dans le dictionnaire lx les mots lus dans le
+//    travail job, dans l'ordre de leur première occurrence, et affecte à
+//    *wsptr l'ensemble trié de leurs identifiants, ou nullptr si wsptr vaut
+//    nullptr. Renvoie 0 en cas de succès, -1 en cas d'erreur d'allocation.
+static int ingest_merge_file(ingest_job_t *job, lexicon *lx, wordset **wsptr,
+    const char *filename) {
+  wordset *words_ws = nullptr;
+  if (wsptr != nullptr) {
+    words_ws = wordset_empty();
+    if (words_ws == nullptr) {
+      fprintf(stderr, "Error: Failed to allocate wordset for file '%s'\n",
+          filename);
+      return -1;
+    }
+  }
+  for (size_t k = 0; k < job->count; ++k) {
+    uint32_t id = lexicon_intern(lx, job->words[k]);
+    if (id == LEXICON_NOID) {
+      fprintf(stderr,
+          "Error: lexicon_intern failed for word '%s' in file '%s'\n",
+          job->words[k], filename);
+      wordset_dispose(&words_ws);
+      return -1;
+    }
+    if (words_ws != nullptr && wordset_put(words_ws, id) != 0) {
+      fprintf(stderr,
+          "Error: wordset_put failed for word '%s' in file '%s'\n",
+          job->words[k], filename);
+      wordset_dispose(&words_ws);
+      return -1;
+    }
+  }
+  if (wsptr != nullptr) {
+    wordset_sort(words_ws);
+    *wsptr = words_ws;
+  }
+  return 0;
+}
+
+//  get_corpus_words_parallel : comme get_corpus_words, avec pool le groupe de
+//    fils d'ingestion déjà lancé sur le contexte ctx, ou nullptr, auquel cas
+//    le fil principal lit lui-même chaque fichier, sans recourir au verrou ni
+//    à la condition du contexte, qui peuvent alors ne pas être initialisés.
+//    Le fil principal intègre les fichiers dans l'ordre, au fur et à mesure
+//    de l'achèvement de leur lecture, en émettant d'abord les messages de
+//    chacun.
+static size_t get_corpus_words_parallel(ingest_context_t *ctx,
+    threadpool *pool, lexicon *lx, wordset **file_sets) {
+  size_t i = 0;
+  for (; i < ctx->num_files; ++i) {
+    ingest_job_t *job = &ctx->jobs[i];
+    if (pool == nullptr) {
+      ingest_read_file(ctx, i);
+      job->done = true;
+    } else {
+      pthread_mutex_lock(&ctx->mutex);
+      while (!job->done) {
+        pthread_cond_wait(&ctx->cond, &ctx->mutex);
+      }
+      pthread_mutex_unlock(&ctx->mutex);
+    }
+    if (job->diag_text != nullptr) {
+      fwrite(job->diag_text, 1, job->diag_length, stderr);
+    }
+    if (ctx->records != nullptr) {
+      ctx->records[i].truncated_text = job->truncated_text;
+      ctx->records[i].truncated_length = job->truncated_length;
+      job->truncated_text = nullptr;
+    }
+    int r = job->status;
+    if (r == 0) {
+      r = ingest_merge_file(job, lx, file_sets == nullptr ? nullptr
+          : &file_sets[i], ctx->filenames[i]);
+      if (r != 0) {
+        fprintf(stderr,
+            "An error occurred during word processing for file '%s'.\n",
+            ctx->filenames[i]);
+      }
+    }
+    ingest_job_dispose(job);
+    if (pool != nullptr) {
+      pthread_mutex_lock(&ctx->mutex);
+    }
+    if (r != 0) {
+      ctx->abort = true;
+    } else {
+      ctx->merged = i + 1;
+    }
+    if (pool != nullptr) {
+      pthread_cond_broadcast(&ctx->cond);
+      pthread_mutex_unlock(&ctx->mutex);
+    }
+    if (r != 0) {
+      break;
+    }
+  }
+  threadpool_join(&pool);
+  for (size_t k = i; k < ctx->num_files; ++k) {
+    ingest_job_dispose(&ctx->jobs[k]);
+  }
+  return i;
+}
+
+size_t get_corpus_words(char **filenames, size_t num_files, lexicon *lx,
+    minhash **signatures, int initial_letters_limit,
+    bool punctuation_as_space, size_t num_threads, wordcache *cache,
+    const corpusindex *index, jdis_file_record *records, wordset **file_sets) {
+  if (num_threads > num_files) {
+    num_threads = num_files;
+  }
+  for (size_t i = 0; records != nullptr && i < num_files; ++i) {
+    records[i] = (jdis_file_record) {
+      .slot = CORPUSINDEX_NONE,
+      .indexable = false,
+      .truncated_text = nullptr,
+      .truncated_length = 0,
+    };
+  }
+  if (num_threads > 1 || cache != nullptr || records != nullptr) {
+    ingest_context_t ctx = {
+      .filenames = filenames,
+      .num_files = num_files,
+      .signatures = signatures,
+      .initial_letters_limit = initial_letters_limit,
+      .punctuation_as_space = punctuation_as_space,
+      .cache = cache,
+      .index = records == nullptr ? nullptr : index,
+      .records = records,
+      .jobs = calloc(num_files, sizeof(ingest_job_t)),
+      .next = 0,
+      .merged = 0,
+      .window = num_threads * INGEST_WINDOW_PER_THREAD,
+      .abort = false,
+    };
+    if (ctx.jobs != nullptr) {
+      //  Faute de verrou ou de condition, les fichiers sont lus par le fil
+      //    principal seul.
+      bool synced = pthread_mutex_init(&ctx.mutex, nullptr) == 0;
+      if (synced && pthread_cond_init(&ctx.cond, nullptr) != 0) {
+        pthread_mutex_destroy(&ctx.mutex);
+        synced = false;
+      }
+      threadpool *pool = num_threads > 1 && synced
+          ? threadpool_start(num_threads, ingest_worker, &ctx) : nullptr;
+      size_t n = get_corpus_words_parallel(&ctx, pool, lx, file_sets);
+      if (synced) {
+        pthread_cond_destroy(&ctx.cond);
+        pthread_mutex_destroy(&ctx.mutex);
+      }
+      free(ctx.jobs);
+      return n;
+    }
+  }
+  for (size_t i = 0; i < num_files; ++i) {
+    wordset *ws = get_words(filenames[i], lx,
+        signatures == nullptr ? nullptr : signatures[i],
+        initial_letters_limit, punctuation_as_space);
+    if (ws == nullptr) {
+      return i;
+    }
+    if (file_sets != nullptr) {
+      file_sets[i] = ws;
+    } else {
+      wordset_dispose(&ws);
+    }
   }
-  fprintf(stderr, "An error occurred during word processing for file '%s'.\n",
-      filename);
-  return nullptr;
+  return num_files;
 }
 
 void print_usage(void) {
@@ -272,7 +834,131 @@ void print_help(void) {
       "        Make the punctuation characters play the same role as white-space\n");
   printf("        characters in the meaning of words.\n");
   printf("\n");
+  printf("  --files-from=LIST, --files-from LIST\n");
+  printf(
+      "        Also process the FILEs whose names are read from LIST, one per line,\n");
+  printf(
+      "        after those given on the command line. Empty lines are ignored.\n");
+  printf(
+      "        Read the standard input if LIST is '-'. There is no limit on the\n");
+  printf("        number of FILEs.\n");
+  printf("\n");
+  printf("Processing Control\n");
+  printf("  -e NAME, --engine=NAME\n");
+  printf(
+      "        Select how the dissimilarities of all pairs of FILEs are computed. NAME\n");
+  printf(
+      "        is 'merge' (the sorted sets of words of each pair are merged),\n");
+  printf(
+      "        'bitset' (a bit matrix of FILEs by words is built and common words\n");
+  printf(
+      "        are counted by blocks of FILEs), 'index' (the FILEs containing each\n");
+  printf(
+      "        word are listed and common words are counted by walking these lists,\n");
+  printf(
+      "        which suits FILEs sharing few words), 'join' (with --max-distance\n");
+  printf(
+      "        below 1, only the pairs sharing one of their rarest words and whose\n");
+  printf(
+      "        sizes allow the threshold are computed; merge is used otherwise) or\n");
+  printf(
+      "        'auto' (the engine with the lowest estimated cost).\n");
+  printf("        Default is auto.\n");
+  printf("\n");
+  printf("  --minhash K, --minhash=K\n");
+  printf(
+      "        Estimate dissimilarities instead of computing them exactly. A signature\n");
+  printf(
+      "        of K values (1 <= K <= %d) is computed for each FILE while it is\n",
+      MINHASH_MAX_SIZE);
+  printf(
+      "        read, and the dissimilarity of a pair is estimated from the two\n");
+  printf(
+      "        signatures in time proportional to K. The estimate of a similarity J\n");
+  printf(
+      "        is unbiased, with standard error sqrt(J (1 - J) / K), at most\n");
+  printf(
+      "        1 / (2 sqrt(K)): 0.0442 for K = 128, 0.0313 for K = 256. With\n");
+  printf(
+      "        probability at least 95%%, it differs from the exact value by less\n");
+  printf(
+      "        than 1.36 / sqrt(K). Each signature takes 4 K bytes. Ignored in\n");
+  printf("        graph mode.\n");
+  printf("\n");
+  printf("  --lsh BANDS, --lsh=BANDS\n");
+  printf(
+      "        Only compare the pairs of FILEs whose MinHash signatures (of K = 128\n");
+  printf(
+      "        values unless --minhash is given) agree on all the values of at least\n");
+  printf(
+      "        one of BANDS bands of R = K / BANDS consecutive values. A pair with\n");
+  printf(
+      "        similarity S is compared with probability 1 - (1 - S^R)^BANDS, which\n");
+  printf(
+      "        rises steeply around S = (1 / BANDS)^(1 / R). The dissimilarities of\n");
+  printf(
+      "        compared pairs are exact. Ignored in graph mode.\n");
+  printf("\n");
+  printf("  -j N, --jobs=N\n");
+  printf(
+      "        Read FILEs and compute the dissimilarities of their pairs, or sort\n");
+  printf(
+      "        the words in graph mode, with N threads of execution\n");
+  printf(
+      "        (1 <= N <= %d). Messages and results are the same, in the same\n",
+      THREADPOOL_MAX_THREADS);
+  printf("        order, whatever N is. Default is 1.\n");
+  printf("\n");
+  printf("  --cache=DIR, --cache DIR\n");
+  printf(
+      "        Keep the distinct words of each regular FILE in directory DIR,\n");
+  printf(
+      "        created if needed. A FILE whose path, device, inode, size and\n");
+  printf(
+      "        modification time are unchanged since it was last read with the\n");
+  printf(
+      "        same -i and -p options is not read again. Outdated entries are\n");
+  printf("        rewritten. Messages and results are unchanged.\n");
+  printf("\n");
+  printf("  --index=FILE, --index FILE\n");
+  printf(
+      "        Keep in FILE the distinct words of each FILE and the dissimilarities\n");
+  printf(
+      "        of all pairs. A regular FILE already in the index under the same\n");
+  printf(
+      "        name, with unchanged device, inode, size and modification time, is\n");
+  printf(
+      "        not read again, and only the dissimilarities of pairs involving new\n");
+  printf(
+      "        or changed FILEs are computed. The index is then rewritten for the\n");
+  printf(
+      "        given FILEs, which costs time and space quadratic in their number,\n");
+  printf(
+      "        unless they are exactly the FILEs of the index, unchanged and in the\n");
+  printf(
+      "        same order. An index written with other -i or -p options is\n");
+  printf(
+      "        ignored. Results are unchanged. Incompatible with -g, --minhash and\n");
+  printf("        --lsh.\n");
+  printf("\n");
   printf("Output Control\n");
+  printf("  --max-distance D, --max-distance=D\n");
+  printf(
+      "        Only display the pairs of FILEs whose dissimilarity is at most D\n");
+  printf("        (0 <= D <= 1). Default is 1.\n");
+  printf("\n");
+  printf("  --top K, --top=K\n");
+  printf(
+      "        For each FILE, in order, only display the pairs it forms with the K\n");
+  printf(
+      "        FILEs most similar to it (K >= 1), the FILE itself first, by\n");
+  printf(
+      "        increasing dissimilarity, ties being broken by the order of FILEs.\n");
+  printf(
+      "        Pairs whose set sizes alone rule them out are not compared.\n");
+  printf(
+      "        Incompatible with -g, --minhash, --lsh and --index.\n");
+  printf("\n");
   printf("  -g, --graph\n");
   printf(
       "        Suppress normal output. Instead, for each word found in any FILE, jdis\n");
@@ -296,340 +982,1344 @@ void print_help(void) {
       "White-space and punctuation characters conform to the standard.\n");
 }
 
-//  fun1_populate_temp_ht : fonction pour holdall_apply_context. Ajoute word_ref
-//    à la table de hachage pointée par context_temp_ht.
-//    Renvoie le résultat de hashtable_add (un pointeur vers la valeur associée
-//    à la clé, ou nullptr en cas d'erreur ou si la clé existait déjà et que la
-//    table ne permet pas les doublons, bien qu'ici les mots soient uniques
-//    par construction de ha1).
-static void *fun1_populate_temp_ht(void *context_temp_ht, void *word_ref) {
-  hashtable *temp_ht = (hashtable *) context_temp_ht;
-  return hashtable_add(temp_ht, word_ref, (void *) 1);
+//  jaccard_from_counts : renvoie la dissimilarité de Jaccard de deux ensembles
+//    de cardinaux count1 et count2 ayant common éléments communs. Renvoie 0.0f
+//    si les deux ensembles sont vides.
+static float jaccard_from_counts(size_t count1, size_t count2,
+    size_t common) {
+  if (count1 == 0 && count2 == 0) {
+    return 0.0f;
+  }
+  size_t union_size = count1 + count2 - common;
+  return (union_size
+    == 0) ? 0.0f : 1.0f - ((float) common / (float) union_size);
 }
 
-//  fun2_check_populate_error : fonction pour holdall_apply_context. Vérifie si
-//    l'opération d'ajout (dont le résultat est add_result_from_fun1) dans la
-//    table de hachage a échoué.
-//    Renvoie 1 si add_result_from_fun1 est nullptr (erreur), sinon 0.
-//    word_ref n'est pas utilisé.
-static int fun2_check_populate_error(void *word_ref,
-    void *add_result_from_fun1) {
-  (void) word_ref;
-  return (add_result_from_fun1 == nullptr) ? 1 : 0;
+float jaccard_distance(const wordset *ws1, const wordset *ws2) {
+  if (ws1 == nullptr || ws2 == nullptr) {
+    return 1.0f;
+  }
+  return jaccard_from_counts(wordset_count(ws1), wordset_count(ws2),
+      wordset_intersection_count(ws1, ws2));
 }
 
-//  jd_count_common_context_t : structure de contexte utilisée pour compter les
-//    éléments communs lors du calcul de la distance de Jaccard.
-//    Membres :
-//      ht_to_search : pointeur vers la table de hachage (contenant les mots
-//                     d'un des ensembles) dans laquelle rechercher.
-//      common_count : pointeur vers un compteur (size_t) à incrémenter pour
-//                     chaque mot commun trouvé.
-typedef struct {
-  hashtable *ht_to_search;
-  size_t *common_count;
-} jd_count_common_context_t;
-
-//  jd_count_common_pass_ctx : fonction pour holdall_apply_context (en tant que
-//    fun1). Passe simplement le contexte 'ctx' à la fonction fun2.
-//    'ref' n'est pas utilisé.
-static void *jd_count_common_pass_ctx(void *ctx, void *ref) {
-  (void) ref;
-  return ctx;
-}
-
-//  jd_count_common_check_word : fonction pour holdall_apply_context (en tant
-// que
-//    fun2). Recherche word_ref_from_ha dans la table de hachage
-//    (context->ht_to_search) et incrémente context->common_count si trouvé.
-//    Renvoie toujours 0 pour continuer le parcours.
-static int jd_count_common_check_word(void *word_ref_from_ha,
-    void *ctx_from_fun1) {
-  jd_count_common_context_t *context
-    = (jd_count_common_context_t *) ctx_from_fun1;
-  if (hashtable_search(context->ht_to_search, word_ref_from_ha) != nullptr) {
-    (*context->common_count)++;
+//  output_open : vide le tampon de stdio de la sortie standard puis tente
+//    d'allouer un tampon d'écriture en bloc sur celle-ci (voir outbuf.h).
+//    Affiche un message d'erreur et renvoie nullptr en cas d'échec.
+static outbuf *output_open(void) {
+  fflush(stdout);
+  outbuf *out = outbuf_empty(STDOUT_FILENO);
+  if (out == nullptr) {
+    fprintf(stderr, "Error: Failed to allocate output buffer.\n");
   }
-  return 0;
+  return out;
 }
 
-float jaccard_distance(holdall *ha1, holdall *ha2) {
-  if (ha1 == nullptr || ha2 == nullptr) {
-    return 1.0f;
+//  output_pair : écrit au moyen de out la ligne de la dissimilarité d du
+//    couple des fichiers de noms name1 et name2, telle que l'écrirait printf
+//    avec le format "%.4f\t%s\t%s\n".
+static void output_pair(outbuf *out, float d, const char *name1,
+    const char *name2) {
+  outbuf_put_fixed4(out, d);
+  outbuf_putc(out, '\t');
+  outbuf_puts(out, name1);
+  outbuf_putc(out, '\t');
+  outbuf_puts(out, name2);
+  outbuf_putc(out, '\n');
+}
+
+//  select_pairs_engine : renvoie le moteur à utiliser pour les num_files
+//    ensembles file_sets dont les mots sont internés dans lx, lorsque le moteur
+//    demandé est engine et la dissimilarité maximale max_distance, all_pairs
+//    indiquant si les dissimilarités sont calculées ligne par ligne pour tous
+//    les couples, seul cas où l'index inversé et la jointure peuvent être
+//    retenus par le choix automatique. Le choix automatique retient la
+//    matrice binaire lorsqu'elle tient dans JDIS_BITSET_MAX_BYTES et qu'une de
+//    ses lignes ne compte pas plus de mots de 64 bits que le double du
+//    cardinal moyen des ensembles, c'est-à-dire lorsque comparer deux lignes
+//    ne coute pas plus cher que fusionner deux ensembles, la fusion sinon.
+//    L'index inversé puis, si max_distance est inférieure à 1, la jointure
+//    leur sont préférés lorsque leur coût estimé (voir postings_cost et
+//    simjoin_cost) est inférieur à celui du meilleur moteur, les coûts étant
+//    pondérés par les facteurs JDIS_*_COST_FACTOR.
+static jdis_engine select_pairs_engine(wordset **file_sets, size_t num_files,
+    const lexicon *lx, jdis_engine engine, float max_distance,
+    bool all_pairs) {
+  if (engine != JDIS_ENGINE_AUTO) {
+    return engine;
   }
-  size_t count1 = holdall_count(ha1);
-  size_t count2 = holdall_count(ha2);
-  if (count1 == 0 && count2 == 0) {
-    return 0.0f;
+  if (num_files < 2) {
+    return JDIS_ENGINE_MERGE;
   }
-  hashtable *temp_ht_from_ha1 = hashtable_empty(compare_strings_for_hashtable,
-      hash_string,
-      0.75);
-  if (temp_ht_from_ha1 == nullptr) {
-    fprintf(stderr,
-        "Error: Failed to create temp hashtable for Jaccard distance.\n");
-    return 1.0f;
+  size_t vocabulary_size = lexicon_count(lx);
+  size_t total = 0;
+  for (size_t i = 0; i < num_files; ++i) {
+    if (file_sets[i] != nullptr) {
+      total += wordset_count(file_sets[i]);
+    }
   }
-  if (holdall_apply_context(ha1, temp_ht_from_ha1, fun1_populate_temp_ht,
-      fun2_check_populate_error) != 0) {
-    hashtable_dispose(&temp_ht_from_ha1);
-    fprintf(stderr,
-        "Error: Failed to populate temp hashtable from ha1 for Jaccard distance.\n");
-    return 1.0f;
+  double num_pairs = (double) num_files * (double) (num_files - 1) / 2.0;
+  jdis_engine best = JDIS_ENGINE_MERGE;
+  double best_cost = num_pairs * 2.0 * (double) (total / num_files);
+  if (bitmatrix_size(num_files, vocabulary_size) <= JDIS_BITSET_MAX_BYTES
+      && vocabulary_size / 64 <= 2 * (total / num_files)) {
+    best = JDIS_ENGINE_BITSET;
+    best_cost = num_pairs * (double) (bitmatrix_size(1, vocabulary_size)
+        / sizeof(uint64_t)) * JDIS_BITSET_COST_FACTOR;
   }
-  size_t common = 0;
-  jd_count_common_context_t common_ctx = {
-    temp_ht_from_ha1, &common
-  };
-  holdall_apply_context(ha2, &common_ctx, jd_count_common_pass_ctx,
-      jd_count_common_check_word);
-  hashtable_dispose(&temp_ht_from_ha1);
-  size_t union_size = count1 + count2 - common;
-  return (union_size
-    == 0) ? 0.0f : 1.0f - ((float) common / (float) union_size);
-}
-
-void jdis_dispose_holdall_array(holdall **ha_array, size_t count) {
-  if (ha_array == nullptr) {
-    return;
+  if (!all_pairs) {
+    return best;
   }
-  for (size_t i = 0; i < count; ++i) {
-    if (ha_array[i] != nullptr) {
-      jdis_free_holdall_content(ha_array[i]);
-      holdall_dispose(&ha_array[i]);
+  double index_cost = postings_cost(file_sets, num_files, vocabulary_size);
+  if (index_cost >= 0.0 && index_cost * JDIS_INDEX_COST_FACTOR < best_cost) {
+    best = JDIS_ENGINE_INDEX;
+    best_cost = index_cost * JDIS_INDEX_COST_FACTOR;
+  }
+  if (max_distance < 1.0f) {
+    double join_cost = simjoin_cost(file_sets, num_files, vocabulary_size,
+        max_distance);
+    if (join_cost >= 0.0 && join_cost * JDIS_JOIN_COST_FACTOR < best_cost) {
+      best = JDIS_ENGINE_JOIN;
     }
   }
-  free(ha_array);
+  return best;
 }
 
-//  hgo_populate_temp_ht_context_t : structure de contexte utilisée pour peupler
-//    les tables de hachage temporaires pour chaque fichier dans le mode
-//    graphique.
+//  JDIS_PAIRS_TILE : nombre de lignes et de colonnes d'une tuile du triangle
+//    des couples de fichiers, calculée d'un seul tenant par un fil avec le
+//    moteur par fusion. Les ensembles des lignes et des colonnes d'une tuile
+//    restent ainsi en cache pendant son calcul.
+#define JDIS_PAIRS_TILE 32
+
+//  pairs_stripe_t : bande de lignes [j0, j0 + rows[ du triangle des couples,
+//    en cours de calcul ou en attente d'affichage.
 //    Membres :
-//      ht : pointeur vers la table de hachage à peupler.
-//      error_flag : indicateur d'erreur (int), mis à 1 en cas d'échec
-//                   d'allocation.
+//      distances : dissimilarités des couples (j, k) de la bande, rangées en
+//                  distances[(j - j0) * num_files + k].
+//      pending : nombre de tuiles de la bande dont le calcul n'est pas achevé.
 typedef struct {
-  hashtable *ht;
-  int error_flag;
-} hgo_populate_temp_ht_context_t;
-
-//  hgo_populate_temp_ht_pass_ctx : fonction pour holdall_apply_context (en tant
-//    que fun1). Passe simplement le contexte 'ctx' à la fonction fun2.
-//    'ref' n'est pas utilisé.
-static void *hgo_populate_temp_ht_pass_ctx(void *ctx, void *ref) {
-  (void) ref;
-  return ctx;
-}
-
-//  hgo_populate_temp_ht_add_word : fonction pour holdall_apply_context (en tant
-//    que fun2). Ajoute word_ref à la table de hachage context->ht.
-//    Met context->error_flag à 1 et renvoie 1 en cas d'échec d'allocation
-//    pour une nouvelle clé (non déjà présente). Sinon, renvoie 0.
-static int hgo_populate_temp_ht_add_word(void *word_ref, void *ctx_from_fun1) {
-  hgo_populate_temp_ht_context_t *context
-    = (hgo_populate_temp_ht_context_t *) ctx_from_fun1;
-  if (hashtable_add(context->ht, word_ref, (void *) 1) == nullptr) {
-    void *search_result = hashtable_search(context->ht, word_ref);
-    if (search_result == nullptr) {
-      context->error_flag = 1;
-      return 1;
-    }
-  }
-  return 0;
-}
+  float *distances;
+  size_t pending;
+} pairs_stripe_t;
 
-//  hgo_collect_words_context_t : structure de contexte pour collecter tous les
-//    mots uniques de tous les fichiers dans une table de hachage principale
-//    (master_registry_ht) et un fourretout principal (all_unique_words_ha)
-//    pour le mode graphique.
+//  pairs_context_t : structure de contexte partagée par les fils de calcul
+//    des dissimilarités et le fil principal, qui affiche les bandes dans
+//    l'ordre. Les tuiles sont attribuées dans l'ordre de l'affichage, à la
+//    demande : un fil qui achève une tuile coûteuse n'en retarde pas d'autres.
+//    Au plus window bandes sont en cours à la fois ; la bande s occupe
+//    l'emplacement stripes[s % window]. Les membres next_stripe, next_col,
+//    printed et les membres pending des bandes sont protégés par mutex ;
+//    cond signale toute modification de l'un d'eux.
 //    Membres :
-//      master_registry_ht : pointeur vers la table de hachage principale
-//                           enregistrant tous les mots uniques.
-//      all_unique_words_ha : pointeur vers le fourretout principal stockant
-//                            des pointeurs vers tous les mots uniques (pour
-// tri).
-//      error_flag : indicateur d'erreur (int), mis à 1 en cas d'échec
-//                   d'allocation.
+//      file_sets, num_files : ensembles des mots des fichiers et leur nombre.
+//      matrix : matrice binaire des ensembles, ou nullptr.
+//      index : index inversé des ensembles, ou nullptr. Le moteur par fusion
+//              est utilisé lorsque matrix et index valent tous deux nullptr.
+//      counts : tampons des nombres de mots communs, un par fil, utilisés
+//               avec la matrice binaire ou l'index inversé.
+//      rows : nombre de lignes d'une bande.
+//      cols : nombre de colonnes d'une tuile.
+//      num_stripes : nombre de bandes.
+//      stripes : emplacements des bandes en cours.
+//      window : nombre d'emplacements.
+//      next_stripe, next_col : bande et première colonne de la prochaine
+//                              tuile à attribuer.
+//      printed : nombre de bandes déjà affichées.
 typedef struct {
-  hashtable *master_registry_ht;
-  holdall *all_unique_words_ha;
-  int error_flag;
-} hgo_collect_words_context_t;
-
-//  hgo_collect_words_pass_ctx : fonction pour holdall_apply_context (en tant
-//    que fun1). Passe simplement le contexte 'ctx' à la fonction fun2.
-//    'ref' n'est pas utilisé.
-static void *hgo_collect_words_pass_ctx(void *ctx, void *ref) {
-  (void) ref;
-  return ctx;
-}
-
-//  hgo_collect_words_add_master : fonction pour holdall_apply_context (en tant
-//    que fun2). Si word_key_ref n'est pas dans context->master_registry_ht,
-//    l'ajoute à la fois à context->master_registry_ht et à
-//    context->all_unique_words_ha.
-//    Met context->error_flag à 1 et renvoie 1 en cas d'échec d'allocation.
-//    Sinon, renvoie 0.
-static int hgo_collect_words_add_master(void *word_key_ref,
-    void *ctx_from_fun1) {
-  hgo_collect_words_context_t *ctx
-    = (hgo_collect_words_context_t *) ctx_from_fun1;
-  const char *word_key = (const char *) word_key_ref;
-  if (hashtable_search(ctx->master_registry_ht, word_key) == nullptr) {
-    if (hashtable_add(ctx->master_registry_ht, (void *) word_key,
-        (void *) 1) == nullptr) {
-      ctx->error_flag = 1;
-      return 1;
-    }
-    if (holdall_put(ctx->all_unique_words_ha, (void *) word_key) != 0) {
-      ctx->error_flag = 1;
-      return 1;
-    }
-  }
-  return 0;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  wordset **file_sets;
+  size_t num_files;
+  bitmatrix *matrix;
+  postings *index;
+  size_t **counts;
+  size_t rows;
+  size_t cols;
+  size_t num_stripes;
+  pairs_stripe_t *stripes;
+  size_t window;
+  size_t next_stripe;
+  size_t next_col;
+  size_t printed;
+} pairs_context_t;
+
+//  pairs_intersection_counts : comme bitmatrix_intersection_counts, au moyen
+//    de la matrice binaire matrix si elle ne vaut pas nullptr, de l'index
+//    inversé index sinon.
+static void pairs_intersection_counts(const bitmatrix *matrix,
+    const postings *index, size_t i0, size_t i1, size_t *counts) {
+  if (matrix != nullptr) {
+    bitmatrix_intersection_counts(matrix, i0, i1, counts);
+  } else {
+    postings_intersection_counts(index, i0, i1, counts);
+  }
+}
+
+//  pairs_compute_tile : calcule les dissimilarités des couples (j, k) avec
+//    j < k de la tuile de lignes [j0, j1[ et de colonnes [k0, k1[ et les
+//    range dans la bande stripe. worker est le numéro du fil appelant.
+static void pairs_compute_tile(pairs_context_t *ctx, pairs_stripe_t *stripe,
+    size_t worker, size_t j0, size_t j1, size_t k0, size_t k1) {
+  wordset **file_sets = ctx->file_sets;
+  size_t n = ctx->num_files;
+  if (ctx->matrix == nullptr && ctx->index == nullptr) {
+    for (size_t j = j0; j < j1; ++j) {
+      for (size_t k = (k0 > j ? k0 : j + 1); k < k1; ++k) {
+        stripe->distances[(j - j0) * n + k]
+          = jaccard_distance(file_sets[j], file_sets[k]);
+      }
+    }
+    return;
+  }
+  size_t *counts = ctx->counts[worker];
+  pairs_intersection_counts(ctx->matrix, ctx->index, j0, j1, counts);
+  for (size_t j = j0; j < j1; ++j) {
+    for (size_t k = j + 1; k < n; ++k) {
+      stripe->distances[(j - j0) * n + k]
+        = (file_sets[j] == nullptr || file_sets[k] == nullptr)
+          ? 1.0f
+          : jaccard_from_counts(wordset_count(file_sets[j]),
+          wordset_count(file_sets[k]), counts[(j - j0) * n + k]);
+    }
+  }
+}
+
+//  pairs_worker : fonction de travail d'un fil de calcul des dissimilarités.
+//    Tant qu'il reste des tuiles, s'attribue la prochaine, pourvu que sa bande
+//    ait un emplacement, et la calcule.
+static void pairs_worker(void *context, size_t worker) {
+  pairs_context_t *ctx = context;
+  size_t n = ctx->num_files;
+  pthread_mutex_lock(&ctx->mutex);
+  for (;;) {
+    while (ctx->next_stripe < ctx->num_stripes
+        && ctx->next_stripe >= ctx->printed + ctx->window) {
+      pthread_cond_wait(&ctx->cond, &ctx->mutex);
+    }
+    if (ctx->next_stripe >= ctx->num_stripes) {
+      break;
+    }
+    size_t s = ctx->next_stripe;
+    size_t j0 = s * ctx->rows;
+    size_t j1 = n - j0 < ctx->rows ? n : j0 + ctx->rows;
+    size_t k0 = ctx->next_col;
+    size_t k1 = n - k0 < ctx->cols ? n : k0 + ctx->cols;
+    pairs_stripe_t *stripe = &ctx->stripes[s % ctx->window];
+    if (k0 == j0) {
+      stripe->pending = (n - j0 + ctx->cols - 1) / ctx->cols;
+    }
+    if (k1 == n) {
+      ctx->next_stripe += 1;
+      ctx->next_col = ctx->next_stripe * ctx->rows;
+    } else {
+      ctx->next_col = k1;
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    pairs_compute_tile(ctx, stripe, worker, j0, j1, k0, k1);
+    pthread_mutex_lock(&ctx->mutex);
+    stripe->pending -= 1;
+    if (stripe->pending == 0) {
+      pthread_cond_broadcast(&ctx->cond);
+    }
+  }
+  pthread_mutex_unlock(&ctx->mutex);
+}
+
+//  pairs_dispose_context : libère les tampons alloués pour le contexte ctx.
+static void pairs_dispose_context(pairs_context_t *ctx, size_t num_threads) {
+  if (ctx->stripes != nullptr) {
+    for (size_t s = 0; s < ctx->window; ++s) {
+      free(ctx->stripes[s].distances);
+    }
+    free(ctx->stripes);
+  }
+  if (ctx->counts != nullptr) {
+    for (size_t t = 0; t < num_threads; ++t) {
+      free(ctx->counts[t]);
+    }
+    free(ctx->counts);
+  }
+}
+
+//  handle_pairs_output_parallel : comme la fin de handle_pairs_output, les
+//    dissimilarités étant calculées par num_threads fils, au moyen de la
+//    matrice binaire matrix ou de l'index inversé index si l'un d'eux ne vaut
+//    pas nullptr, par fusion sinon. Le fil principal
+//    affiche chaque bande dès qu'elle est achevée et que les précédentes ont
+//    été affichées, au moyen de out. Renvoie 0 en cas de succès, -1 si les
+//    tampons, les fils ou les moyens de synchronisation n'ont pu être
+//    alloués ; dans ce cas, rien n'a été affiché.
+static int handle_pairs_output_parallel(wordset **file_sets,
+    size_t num_files, char **filenames_in_order, bitmatrix *matrix,
+    postings *index, float max_distance, size_t num_threads, outbuf *out) {
+  bool blocks = matrix != nullptr || index != nullptr;
+  pairs_context_t ctx = {
+    .file_sets = file_sets,
+    .num_files = num_files,
+    .matrix = matrix,
+    .index = index,
+    .counts = nullptr,
+    .rows = blocks ? JDIS_BITSET_ROW_BLOCK : JDIS_PAIRS_TILE,
+    .cols = blocks ? num_files : JDIS_PAIRS_TILE,
+    .stripes = nullptr,
+    .window = 2 * num_threads,
+    .next_stripe = 0,
+    .next_col = 0,
+    .printed = 0,
+  };
+  ctx.num_stripes = (num_files + ctx.rows - 1) / ctx.rows;
+  if (ctx.window > ctx.num_stripes) {
+    ctx.window = ctx.num_stripes;
+  }
+  ctx.stripes = calloc(ctx.window, sizeof *ctx.stripes);
+  if (ctx.stripes == nullptr) {
+    return -1;
+  }
+  for (size_t s = 0; s < ctx.window; ++s) {
+    ctx.stripes[s].distances
+      = malloc(ctx.rows * num_files * sizeof *ctx.stripes[s].distances);
+    if (ctx.stripes[s].distances == nullptr) {
+      pairs_dispose_context(&ctx, num_threads);
+      return -1;
+    }
+  }
+  if (blocks) {
+    ctx.counts = calloc(num_threads, sizeof *ctx.counts);
+    if (ctx.counts == nullptr) {
+      pairs_dispose_context(&ctx, num_threads);
+      return -1;
+    }
+    for (size_t t = 0; t < num_threads; ++t) {
+      ctx.counts[t] = malloc(ctx.rows * num_files * sizeof *ctx.counts[t]);
+      if (ctx.counts[t] == nullptr) {
+        pairs_dispose_context(&ctx, num_threads);
+        return -1;
+      }
+    }
+  }
+  if (pthread_mutex_init(&ctx.mutex, nullptr) != 0) {
+    pairs_dispose_context(&ctx, num_threads);
+    return -1;
+  }
+  if (pthread_cond_init(&ctx.cond, nullptr) != 0) {
+    pthread_mutex_destroy(&ctx.mutex);
+    pairs_dispose_context(&ctx, num_threads);
+    return -1;
+  }
+  threadpool *pool = threadpool_start(num_threads, pairs_worker, &ctx);
+  int r = pool == nullptr ? -1 : 0;
+  if (pool != nullptr) {
+    for (size_t s = 0; s < ctx.num_stripes; ++s) {
+      pairs_stripe_t *stripe = &ctx.stripes[s % ctx.window];
+      pthread_mutex_lock(&ctx.mutex);
+      while (ctx.next_stripe <= s || stripe->pending != 0) {
+        pthread_cond_wait(&ctx.cond, &ctx.mutex);
+      }
+      pthread_mutex_unlock(&ctx.mutex);
+      size_t j0 = s * ctx.rows;
+      size_t j1 = num_files - j0 < ctx.rows ? num_files : j0 + ctx.rows;
+      for (size_t j = j0; j < j1; ++j) {
+        for (size_t k = j + 1; k < num_files; ++k) {
+          float d = stripe->distances[(j - j0) * num_files + k];
+          if (d <= max_distance) {
+            output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+          }
+        }
+      }
+      pthread_mutex_lock(&ctx.mutex);
+      ctx.printed = s + 1;
+      pthread_cond_broadcast(&ctx.cond);
+      pthread_mutex_unlock(&ctx.mutex);
+    }
+    threadpool_join(&pool);
+  }
+  pthread_cond_destroy(&ctx.cond);
+  pthread_mutex_destroy(&ctx.mutex);
+  pairs_dispose_context(&ctx, num_threads);
+  return r;
 }
 
-//  hgo_graph_print_row_context_t : structure de contexte pour l'impression des
-//    lignes de la sortie graphique. Contient les tables de hachage temporaires
-//    de chaque fichier pour une recherche rapide, le nombre de fichiers, et les
-//    noms des fichiers dans l'ordre.
+//  JDIS_JOIN_CHUNK : nombre de fichiers dont les candidats sont cherchés et
+//    vérifiés d'un seul tenant par un fil avec le moteur par jointure.
+#define JDIS_JOIN_CHUNK 64
+
+//  join_pair_t : couple de fichiers retenu par la jointure.
+//    Membres :
+//      first, second : indices des deux fichiers, first < second.
+//      distance : dissimilarité du couple.
+typedef struct {
+  size_t first;
+  size_t second;
+  float distance;
+} join_pair_t;
+
+//  join_chunk_t : couples retenus pour une tranche de JDIS_JOIN_CHUNK
+//    fichiers, dans l'ordre lexicographique.
+//    Membres :
+//      pairs : tableau des couples, ou nullptr.
+//      count, capacity : nombre de couples et capacité du tableau.
+//      complete : indique si la tranche a été entièrement traitée.
+typedef struct {
+  join_pair_t *pairs;
+  size_t count;
+  size_t capacity;
+  bool complete;
+} join_chunk_t;
+
+//  join_context_t : structure de contexte partagée par les fils cherchant
+//    les couples de la jointure. Le membre next est protégé par mutex.
 //    Membres :
-//      temp_file_hts_for_lookup : tableau de pointeurs vers les tables de
-//                                 hachage temporaires (une par fichier).
-//      num_files : nombre total de fichiers.
-//      filenames_in_order : tableau des noms de fichiers.
+//      file_sets, num_files : ensembles de mots des fichiers et leur nombre.
+//      join : index de la jointure.
+//      max_distance : dissimilarité maximale d'un couple.
+//      probes : espaces de travail de la jointure, un par fil.
+//      chunks : couples retenus pour chaque tranche.
+//      num_chunks : nombre de tranches.
+//      next : indice de la prochaine tranche à attribuer à un fil.
 typedef struct {
-  hashtable **temp_file_hts_for_lookup;
+  pthread_mutex_t mutex;
+  wordset **file_sets;
   size_t num_files;
-  char **filenames_in_order;
-} hgo_graph_print_row_context_t;
-
-//  pass_context_identity : fonction pour holdall_apply_context (en tant que
-//    fun1). Passe simplement le 'context' fourni à la fonction fun2.
-//    'word_ref_ptr' n'est pas utilisé.
-static void *pass_context_identity(void *context, void *word_ref_ptr) {
-  (void) word_ref_ptr;
-  return context;
-}
-
-//  print_row_via_fun2 : fonction pour holdall_apply_context (en tant que fun2).
-//    Affiche une ligne pour le mot 'word_ref'. La ligne contient le mot, suivi
-//    d'une tabulation, puis pour chaque fichier (selon
-//    actual_context->filenames_in_order), affiche 'x' si le mot est présent
-//    dans la table de hachage temporaire correspondante du fichier, ou '-'
-// sinon.
-//    Renvoie toujours 0 pour continuer le parcours.
-static int print_row_via_fun2(void *word_ref, void *context_from_fun1) {
-  const char *current_word_str = (const char *) word_ref;
-  hgo_graph_print_row_context_t *actual_context
-    = (hgo_graph_print_row_context_t *) context_from_fun1;
-  printf("%s", current_word_str);
-  for (size_t j = 0; j < actual_context->num_files; ++j) {
-    printf("\t");
-    if (actual_context->temp_file_hts_for_lookup[j] != nullptr
-        && hashtable_search(actual_context->temp_file_hts_for_lookup[j],
-        current_word_str) != nullptr) {
-      printf("x");
-    } else {
-      printf("-");
+  simjoin *join;
+  float max_distance;
+  simjoin_probe **probes;
+  join_chunk_t *chunks;
+  size_t num_chunks;
+  size_t next;
+} join_context_t;
+
+//  join_compute_chunk : cherche, au moyen de l'espace de travail probe, les
+//    couples formés par les fichiers de la tranche c du contexte ctx et les
+//    fichiers suivants, calcule leur dissimilarité comme jaccard_distance à
+//    partir des nombres de mots communs comptés par la jointure et retient
+//    les couples qui ne dépassent pas la dissimilarité maximale. Le membre
+//    complete de la tranche reste faux en cas de dépassement de capacité.
+static void join_compute_chunk(join_context_t *ctx, simjoin_probe *probe,
+    size_t c) {
+  join_chunk_t *chunk = &ctx->chunks[c];
+  size_t n = ctx->num_files;
+  size_t i0 = c * JDIS_JOIN_CHUNK;
+  size_t i1 = n - i0 < JDIS_JOIN_CHUNK ? n : i0 + JDIS_JOIN_CHUNK;
+  for (size_t i = i0; i < i1; ++i) {
+    const simjoin_match *matches;
+    size_t m = simjoin_matches(ctx->join, probe, i, &matches);
+    for (size_t q = 0; q < m; ++q) {
+      size_t k = matches[q].row;
+      float d = jaccard_from_counts(wordset_count(ctx->file_sets[i]),
+          wordset_count(ctx->file_sets[k]), matches[q].common);
+      if (d > ctx->max_distance) {
+        continue;
+      }
+      if (chunk->count == chunk->capacity) {
+        size_t capacity = chunk->capacity == 0 ? 64 : 2 * chunk->capacity;
+        join_pair_t *pairs
+          = realloc(chunk->pairs, capacity * sizeof *pairs);
+        if (pairs == nullptr) {
+          return;
+        }
+        chunk->pairs = pairs;
+        chunk->capacity = capacity;
+      }
+      chunk->pairs[chunk->count] = (join_pair_t) {
+        .first = i, .second = k, .distance = d
+      };
+      chunk->count += 1;
     }
   }
-  printf("\n");
-  return 0;
+  chunk->complete = true;
 }
 
-void handle_graph_output(holdall **file_holdalls, size_t num_files,
-    char **filenames_in_order, int initial_letters_limit) {
-  (void) initial_letters_limit;
-  holdall *all_unique_words_ha = holdall_empty();
-  if (all_unique_words_ha == nullptr) {
-    fprintf(stderr,
-        "Error: Failed to allocate memory for holdall in graph mode.\n");
+//  join_merge_chunk : affiche au moyen de out, dans l'ordre lexicographique,
+//    les couples formés par les fichiers de la tranche c du contexte ctx et
+//    les fichiers suivants dont la dissimilarité, calculée par
+//    jaccard_distance, ne dépasse pas la dissimilarité maximale. Sert de
+//    repli, sans allocation, pour une tranche dont les couples retenus n'ont
+//    pu être mémorisés.
+static void join_merge_chunk(join_context_t *ctx, size_t c,
+    char **filenames_in_order, outbuf *out) {
+  size_t n = ctx->num_files;
+  size_t i0 = c * JDIS_JOIN_CHUNK;
+  size_t i1 = n - i0 < JDIS_JOIN_CHUNK ? n : i0 + JDIS_JOIN_CHUNK;
+  for (size_t i = i0; i < i1; ++i) {
+    for (size_t k = i + 1; k < n; ++k) {
+      float d = jaccard_distance(ctx->file_sets[i], ctx->file_sets[k]);
+      if (d <= ctx->max_distance) {
+        output_pair(out, d, filenames_in_order[i], filenames_in_order[k]);
+      }
+    }
+  }
+}
+
+//  join_worker : fonction de travail d'un fil cherchant les couples de la
+//    jointure. S'attribue des tranches tant qu'il en reste.
+static void join_worker(void *context, size_t worker) {
+  join_context_t *ctx = context;
+  for (;;) {
+    pthread_mutex_lock(&ctx->mutex);
+    size_t c = ctx->next;
+    if (c < ctx->num_chunks) {
+      ctx->next = c + 1;
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    if (c == ctx->num_chunks) {
+      break;
+    }
+    join_compute_chunk(ctx, ctx->probes[worker], c);
+  }
+}
+
+//  handle_join_output : comme la fin de handle_pairs_output, pour une
+//    dissimilarité maximale max_distance strictement inférieure à 1, les
+//    couples étant cherchés par la jointure (voir simjoin.h) au moyen de
+//    num_threads fils. Chaque tranche est affichée, au moyen de out, dès
+//    qu'elle est traitée s'il n'y a qu'un fil, à la fin du traitement sinon ;
+//    une tranche dont les couples n'ont pu être mémorisés est affichée au
+//    moyen de join_merge_chunk. Si le verrou ne peut être initialisé, les
+//    tranches sont toutes traitées par le fil courant. Renvoie 0 en cas de
+//    succès, -1 si l'index ou les espaces de travail n'ont pu être alloués ;
+//    dans ce cas, rien n'a été affiché.
+static int handle_join_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, float max_distance,
+    size_t num_threads, outbuf *out) {
+  size_t num_chunks = (num_files + JDIS_JOIN_CHUNK - 1) / JDIS_JOIN_CHUNK;
+  if (num_threads > num_chunks) {
+    num_threads = num_chunks;
+  }
+  if (num_threads == 0) {
+    num_threads = 1;
+  }
+  join_context_t ctx = {
+    .file_sets = file_sets,
+    .num_files = num_files,
+    .join = simjoin_build(file_sets, num_files, lexicon_count(lx),
+        max_distance),
+    .max_distance = max_distance,
+    .probes = calloc(num_threads, sizeof *ctx.probes),
+    .chunks = calloc(num_chunks + 1, sizeof *ctx.chunks),
+    .num_chunks = num_chunks,
+    .next = 0,
+  };
+  int r = -1;
+  if (ctx.join == nullptr || ctx.probes == nullptr || ctx.chunks == nullptr) {
+    goto cleanup;
+  }
+  for (size_t t = 0; t < num_threads; ++t) {
+    ctx.probes[t] = simjoin_probe_create(ctx.join);
+    if (ctx.probes[t] == nullptr) {
+      goto cleanup;
+    }
+  }
+  r = 0;
+  if (num_threads > 1 && pthread_mutex_init(&ctx.mutex, nullptr) == 0) {
+    threadpool *pool = threadpool_start(num_threads, join_worker, &ctx);
+    threadpool_join(&pool);
+    pthread_mutex_destroy(&ctx.mutex);
+  }
+  size_t computed = ctx.next;
+  bool warned = false;
+  for (size_t c = 0; c < num_chunks; ++c) {
+    join_chunk_t *chunk = &ctx.chunks[c];
+    if (c >= computed) {
+      join_compute_chunk(&ctx, ctx.probes[0], c);
+    }
+    if (!chunk->complete) {
+      if (!warned) {
+        fprintf(stderr,
+            "Warning: Failed to allocate similarity join results. Falling back to merge engine.\n");
+        warned = true;
+      }
+      join_merge_chunk(&ctx, c, filenames_in_order, out);
+      continue;
+    }
+    for (size_t q = 0; q < chunk->count; ++q) {
+      output_pair(out, chunk->pairs[q].distance,
+          filenames_in_order[chunk->pairs[q].first],
+          filenames_in_order[chunk->pairs[q].second]);
+    }
+    free(chunk->pairs);
+    chunk->pairs = nullptr;
+  }
+cleanup:
+  for (size_t c = 0; ctx.chunks != nullptr && c < num_chunks; ++c) {
+    free(ctx.chunks[c].pairs);
+  }
+  free(ctx.chunks);
+  for (size_t t = 0; ctx.probes != nullptr && t < num_threads; ++t) {
+    simjoin_probe_dispose(&ctx.probes[t]);
+  }
+  free(ctx.probes);
+  simjoin_dispose(&ctx.join);
+  return r;
+}
+
+void handle_pairs_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, jdis_engine engine,
+    float max_distance, size_t num_threads) {
+  outbuf *out = output_open();
+  if (out == nullptr) {
     return;
   }
-  hashtable *master_word_registry_ht
-    = hashtable_empty(compare_strings_for_hashtable,
-      hash_string, 0.75);
-  if (master_word_registry_ht == nullptr) {
+  bitmatrix *matrix = nullptr;
+  postings *index = nullptr;
+  size_t *counts = nullptr;
+  jdis_engine selected = select_pairs_engine(file_sets, num_files, lx,
+      engine, max_distance, true);
+  if (selected == JDIS_ENGINE_JOIN && max_distance < 1.0f) {
+    if (handle_join_output(file_sets, num_files, filenames_in_order, lx,
+        max_distance, num_threads, out) == 0) {
+      outbuf_dispose(&out);
+      return;
+    }
     fprintf(stderr,
-        "Error: Failed to allocate memory for master hashtable in graph mode.\n");
-    holdall_dispose(&all_unique_words_ha);
+        "Warning: Failed to allocate similarity join. Falling back to merge engine.\n");
+  }
+  if (selected == JDIS_ENGINE_BITSET) {
+    matrix = bitmatrix_build(file_sets, num_files, lexicon_count(lx));
+    if (matrix == nullptr) {
+      fprintf(stderr,
+          "Warning: Failed to allocate bit matrix. Falling back to merge engine.\n");
+    }
+  } else if (selected == JDIS_ENGINE_INDEX) {
+    index = postings_build(file_sets, num_files, lexicon_count(lx));
+    if (index == nullptr) {
+      fprintf(stderr,
+          "Warning: Failed to allocate inverted index. Falling back to merge engine.\n");
+    }
+  }
+  if (num_threads > 1
+      && handle_pairs_output_parallel(file_sets, num_files,
+      filenames_in_order, matrix, index, max_distance, num_threads,
+      out) == 0) {
+    postings_dispose(&index);
+    bitmatrix_dispose(&matrix);
+    outbuf_dispose(&out);
     return;
   }
-  hashtable **temp_file_hts_for_lookup = calloc(num_files, sizeof(hashtable *));
-  if (temp_file_hts_for_lookup == nullptr) {
-    fprintf(stderr,
-        "Error: Failed to allocate array for temp lookup HTs in graph mode.\n");
-    goto cleanup_graph_main_resources;
+  if (matrix != nullptr || index != nullptr) {
+    counts = malloc(JDIS_BITSET_ROW_BLOCK * num_files * sizeof *counts);
+    if (counts == nullptr) {
+      if (matrix != nullptr) {
+        fprintf(stderr,
+            "Warning: Failed to allocate bit matrix. Falling back to merge engine.\n");
+      } else {
+        fprintf(stderr,
+            "Warning: Failed to allocate inverted index. Falling back to merge engine.\n");
+      }
+      postings_dispose(&index);
+      bitmatrix_dispose(&matrix);
+    }
   }
-  for (size_t i = 0; i < num_files; ++i) {
-    if (file_holdalls[i] == nullptr) {
-      continue;
+  if (matrix == nullptr && index == nullptr) {
+    for (size_t j = 0; j < num_files; ++j) {
+      for (size_t k = j + 1; k < num_files; ++k) {
+        float d = jaccard_distance(file_sets[j], file_sets[k]);
+        if (d <= max_distance) {
+          output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+        }
+      }
     }
-    hgo_collect_words_context_t collect_ctx = {
-      master_word_registry_ht, all_unique_words_ha, 0
-    };
-    if (holdall_apply_context(file_holdalls[i], &collect_ctx,
-        hgo_collect_words_pass_ctx, hgo_collect_words_add_master) != 0
-        || collect_ctx.error_flag) {
+    outbuf_dispose(&out);
+    return;
+  }
+  for (size_t i0 = 0; i0 < num_files; i0 += JDIS_BITSET_ROW_BLOCK) {
+    size_t i1 = num_files - i0 < JDIS_BITSET_ROW_BLOCK ? num_files
+        : i0 + JDIS_BITSET_ROW_BLOCK;
+    pairs_intersection_counts(matrix, index, i0, i1, counts);
+    for (size_t j = i0; j < i1; ++j) {
+      for (size_t k = j + 1; k < num_files; ++k) {
+        float d = (file_sets[j] == nullptr || file_sets[k] == nullptr)
+            ? 1.0f
+            : jaccard_from_counts(wordset_count(file_sets[j]),
+            wordset_count(file_sets[k]), counts[(j - i0) * num_files + k]);
+        if (d <= max_distance) {
+          output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+        }
+      }
+    }
+  }
+  free(counts);
+  postings_dispose(&index);
+  bitmatrix_dispose(&matrix);
+  outbuf_dispose(&out);
+}
+
+//  JDIS_TOP_CHUNK : nombre de fichiers dont les plus proches voisins sont
+//    cherchés d'un seul tenant par un fil en mode --top.
+#define JDIS_TOP_CHUNK 64
+
+//  top_entry_t : voisin d'un fichier en mode --top.
+//    Membres :
+//      distance : dissimilarité du couple formé par le fichier et son voisin.
+//      file : indice du voisin.
+typedef struct {
+  float distance;
+  size_t file;
+} top_entry_t;
+
+//  top_key_t : clé de tri d'un fichier en mode --top.
+//    Membres :
+//      count : cardinal de l'ensemble de mots du fichier.
+//      file : indice du fichier.
+typedef struct {
+  size_t count;
+  size_t file;
+} top_key_t;
+
+//  top_context_t : structure de contexte partagée par les fils calculant les
+//    plus proches voisins des fichiers. Le membre next est protégé par mutex.
+//    Membres :
+//      file_sets, num_files : ensembles de mots des fichiers et leur nombre.
+//      matrix : matrice binaire fichiers × mots, ou nullptr si les
+//               dissimilarités sont calculées par fusion des ensembles.
+//      k : nombre maximal de voisins d'un fichier.
+//      max_distance : dissimilarité maximale d'un voisin.
+//      order : clés des fichiers triées par cardinal croissant puis par
+//              indice croissant.
+//      position : position de chaque fichier dans order.
+//      entries : voisins des fichiers, ceux du fichier d'indice i étant
+//                rangés à partir de entries[i * k].
+//      counts : nombre de voisins de chaque fichier.
+//      next : indice du prochain fichier à attribuer à un fil.
+typedef struct {
+  pthread_mutex_t mutex;
+  wordset **file_sets;
+  size_t num_files;
+  const bitmatrix *matrix;
+  size_t k;
+  float max_distance;
+  top_key_t *order;
+  size_t *position;
+  top_entry_t *entries;
+  size_t *counts;
+  size_t next;
+} top_context_t;
+
+//  top_count : renvoie le cardinal de l'ensemble ws, ou 0 s'il vaut nullptr.
+static size_t top_count(const wordset *ws) {
+  return ws == nullptr ? 0 : wordset_count(ws);
+}
+
+//  top_before : indique si le voisin pointé par a est plus proche que celui
+//    pointé par b, les égalités de dissimilarité étant départagées par les
+//    indices.
+static bool top_before(const top_entry_t *a, const top_entry_t *b) {
+  return a->distance < b->distance
+    || (a->distance == b->distance && a->file < b->file);
+}
+
+//  compare_top_entries : fonction de comparaison pour qsort des voisins, du
+//    plus proche au plus lointain.
+static int compare_top_entries(const void *a, const void *b) {
+  return top_before(a, b) ? -1 : top_before(b, a) ? 1 : 0;
+}
+
+//  top_push : ajoute le voisin e au tas max heap de *countptr voisins et de
+//    capacité k si le tas n'est pas plein ou si e est plus proche que le plus
+//    lointain d'entre eux, qu'il remplace alors.
+static void top_push(top_entry_t *heap, size_t *countptr, size_t k,
+    top_entry_t e) {
+  size_t n = *countptr;
+  if (n < k) {
+    size_t i = n;
+    while (i > 0 && top_before(&heap[(i - 1) / 2], &e)) {
+      heap[i] = heap[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+    heap[i] = e;
+    *countptr = n + 1;
+    return;
+  }
+  if (!top_before(&e, &heap[0])) {
+    return;
+  }
+  size_t i = 0;
+  for (;;) {
+    size_t c = 2 * i + 1;
+    if (c >= n) {
+      break;
+    }
+    if (c + 1 < n && top_before(&heap[c], &heap[c + 1])) {
+      c += 1;
+    }
+    if (!top_before(&e, &heap[c])) {
+      break;
+    }
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = e;
+}
+
+//  top_compute_file : cherche les plus proches voisins du fichier d'indice i
+//    du contexte ctx. Les autres fichiers sont parcourus à partir de la
+//    position de i dans l'ordre des cardinaux, en s'en éloignant de part et
+//    d'autre et en prenant à chaque pas celui dont le minorant de
+//    dissimilarité tiré des cardinaux, 1 - min / max, est le plus petit. Ce
+//    minorant croît à mesure que l'on s'éloigne : le parcours s'arrête dès
+//    qu'il dépasse la dissimilarité maximale ou, le tas étant plein, celle du
+//    plus lointain des voisins retenus.
+static void top_compute_file(top_context_t *ctx, size_t i) {
+  top_entry_t *heap = &ctx->entries[i * ctx->k];
+  size_t count = 0;
+  size_t n = ctx->num_files;
+  size_t ci = top_count(ctx->file_sets[i]);
+  size_t lo = ctx->position[i];
+  size_t hi = lo + 1;
+  while (lo > 0 || hi < n) {
+    float blo = lo == 0 ? 2.0f : jaccard_from_counts(ci,
+        ctx->order[lo - 1].count, ctx->order[lo - 1].count);
+    float bhi = hi == n ? 2.0f : jaccard_from_counts(ci,
+        ctx->order[hi].count, ci);
+    float bound = blo <= bhi ? blo : bhi;
+    float limit = count == ctx->k ? heap[0].distance : ctx->max_distance;
+    if (bound > limit) {
+      break;
+    }
+    size_t j = blo <= bhi ? ctx->order[--lo].file : ctx->order[hi++].file;
+    float d = ctx->matrix == nullptr
+        || ctx->file_sets[i] == nullptr || ctx->file_sets[j] == nullptr
+        ? jaccard_distance(ctx->file_sets[i], ctx->file_sets[j])
+        : jaccard_from_counts(ci, wordset_count(ctx->file_sets[j]),
+        bitmatrix_common_count(ctx->matrix, i, j));
+    if (d <= ctx->max_distance) {
+      top_push(heap, &count, ctx->k, (top_entry_t) {
+        .distance = d, .file = j
+      });
+    }
+  }
+  qsort(heap, count, sizeof *heap, compare_top_entries);
+  ctx->counts[i] = count;
+}
+
+//  top_worker : fonction de travail d'un fil calculant les plus proches
+//    voisins. S'attribue des tranches de JDIS_TOP_CHUNK fichiers tant qu'il en
+//    reste.
+static void top_worker(void *context, size_t worker) {
+  (void) worker;
+  top_context_t *ctx = context;
+  for (;;) {
+    pthread_mutex_lock(&ctx->mutex);
+    size_t i0 = ctx->next;
+    size_t i1 = ctx->num_files - i0 < JDIS_TOP_CHUNK ? ctx->num_files
+        : i0 + JDIS_TOP_CHUNK;
+    ctx->next = i1;
+    pthread_mutex_unlock(&ctx->mutex);
+    if (i0 == i1) {
+      break;
+    }
+    for (size_t i = i0; i < i1; ++i) {
+      top_compute_file(ctx, i);
+    }
+  }
+}
+
+//  compare_top_keys : fonction de comparaison pour qsort des clés de
+//    fichiers, par cardinal croissant puis par indice croissant.
+static int compare_top_keys(const void *a, const void *b) {
+  const top_key_t *x = a;
+  const top_key_t *y = b;
+  if (x->count != y->count) {
+    return x->count < y->count ? -1 : 1;
+  }
+  return (x->file > y->file) - (x->file < y->file);
+}
+
+int handle_top_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, jdis_engine engine,
+    size_t k, float max_distance, size_t num_threads) {
+  if (k > num_files - 1) {
+    k = num_files - 1;
+  }
+  bitmatrix *matrix = nullptr;
+  if (select_pairs_engine(file_sets, num_files, lx, engine, max_distance,
+      false) == JDIS_ENGINE_BITSET) {
+    matrix = bitmatrix_build(file_sets, num_files, lexicon_count(lx));
+    if (matrix == nullptr) {
       fprintf(stderr,
-          "Error: Failed while collecting unique words for graph mode.\n");
-      goto cleanup_graph_all_resources;
+          "Warning: Failed to allocate bit matrix. Falling back to merge engine.\n");
     }
   }
+  top_context_t ctx = {
+    .file_sets = file_sets,
+    .num_files = num_files,
+    .matrix = matrix,
+    .k = k,
+    .max_distance = max_distance,
+    .order = malloc(num_files * sizeof *ctx.order),
+    .position = malloc(num_files * sizeof *ctx.position),
+    .entries = malloc(num_files * (k == 0 ? 1 : k) * sizeof *ctx.entries),
+    .counts = malloc(num_files * sizeof *ctx.counts),
+    .next = 0,
+  };
+  outbuf *out = nullptr;
+  int r = -1;
+  if (ctx.order == nullptr || ctx.position == nullptr
+      || ctx.entries == nullptr || ctx.counts == nullptr) {
+    fprintf(stderr, "Error: Failed to allocate nearest neighbour tables.\n");
+    goto cleanup;
+  }
+  for (size_t i = 0; i < num_files; ++i) {
+    ctx.order[i] = (top_key_t) {
+      .count = top_count(file_sets[i]), .file = i
+    };
+  }
+  qsort(ctx.order, num_files, sizeof *ctx.order, compare_top_keys);
+  for (size_t p = 0; p < num_files; ++p) {
+    ctx.position[ctx.order[p].file] = p;
+  }
+  if (num_threads > num_files / JDIS_TOP_CHUNK) {
+    num_threads = num_files / JDIS_TOP_CHUNK;
+  }
+  threadpool *pool = nullptr;
+  if (num_threads > 1 && pthread_mutex_init(&ctx.mutex, nullptr) == 0) {
+    pool = threadpool_start(num_threads, top_worker, &ctx);
+    threadpool_join(&pool);
+    pthread_mutex_destroy(&ctx.mutex);
+  }
+  for (size_t i = ctx.next; i < num_files; ++i) {
+    top_compute_file(&ctx, i);
+  }
+  out = output_open();
+  if (out == nullptr) {
+    goto cleanup;
+  }
   for (size_t i = 0; i < num_files; ++i) {
-    if (file_holdalls[i] != nullptr && holdall_count(file_holdalls[i]) > 0) {
-      temp_file_hts_for_lookup[i]
-        = hashtable_empty(compare_strings_for_hashtable,
-          hash_string, 0.75);
-      if (temp_file_hts_for_lookup[i] == nullptr) {
-        fprintf(stderr, "Error: Failed to create temp lookup HT for file %s.\n",
-            filenames_in_order[i]);
-        goto cleanup_graph_all_resources;
+    const top_entry_t *e = &ctx.entries[i * k];
+    for (size_t m = 0; m < ctx.counts[i]; ++m) {
+      output_pair(out, e[m].distance, filenames_in_order[i],
+          filenames_in_order[e[m].file]);
+    }
+  }
+  r = 0;
+cleanup:
+  outbuf_dispose(&out);
+  free(ctx.counts);
+  free(ctx.entries);
+  free(ctx.position);
+  free(ctx.order);
+  bitmatrix_dispose(&matrix);
+  return r;
+}
+
+//  indexed_add_file : ajoute à l'index en cours d'écriture associé à w le
+//    fichier de nom name, d'informations de lecture *record, dont les mots
+//    sont ceux de l'ensemble ws internés dans lx, en se servant du tableau
+//    *wordsptr de capacité *capacityptr, agrandi si nécessaire. Renvoie 0 en
+//    cas de succès, -1 en cas d'échec.
+static int indexed_add_file(corpusindex_writer *w, const char *name,
+    const jdis_file_record *record, const wordset *ws, const lexicon *lx,
+    const char ***wordsptr, size_t *capacityptr) {
+  size_t count = ws == nullptr ? 0 : wordset_count(ws);
+  if (count > *capacityptr) {
+    const char **a = realloc(*wordsptr, count * sizeof *a);
+    if (a == nullptr) {
+      return -1;
+    }
+    *wordsptr = a;
+    *capacityptr = count;
+  }
+  for (size_t k = 0; k < count; ++k) {
+    (*wordsptr)[k] = lexicon_word(lx, wordset_ids(ws)[k]);
+  }
+  return corpusindex_writer_add_file(w, name,
+      record->indexable ? &record->st : nullptr, *wordsptr, count,
+      record->truncated_text == nullptr ? "" : record->truncated_text,
+      record->truncated_length);
+}
+
+int handle_indexed_pairs_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, const corpusindex *index,
+    const jdis_file_record *records, const char *index_filename,
+    int initial_letters_limit, bool punctuation_as_space, float max_distance) {
+  outbuf *out = output_open();
+  if (out == nullptr) {
+    return -1;
+  }
+  bool unchanged = index != nullptr && corpusindex_count(index) == num_files;
+  for (size_t j = 0; unchanged && j < num_files; ++j) {
+    unchanged = records[j].slot == j;
+  }
+  corpusindex_writer *w = unchanged ? nullptr
+      : corpusindex_writer_create(index_filename, initial_letters_limit,
+      punctuation_as_space, num_files);
+  const char **words = nullptr;
+  size_t capacity = 0;
+  for (size_t j = 0; w != nullptr && j < num_files; ++j) {
+    if (indexed_add_file(w, filenames_in_order[j], &records[j], file_sets[j],
+        lx, &words, &capacity) != 0) {
+      corpusindex_writer_discard(&w);
+    }
+  }
+  free(words);
+  for (size_t j = 0; j < num_files; ++j) {
+    size_t sj = records[j].slot;
+    for (size_t k = j + 1; k < num_files; ++k) {
+      size_t sk = records[k].slot;
+      float d = (sj != CORPUSINDEX_NONE && sk != CORPUSINDEX_NONE && sj != sk)
+          ? corpusindex_distance(index, sj, sk)
+          : jaccard_distance(file_sets[j], file_sets[k]);
+      if (w != nullptr && corpusindex_writer_put_distance(w, d) != 0) {
+        corpusindex_writer_discard(&w);
       }
-      hgo_populate_temp_ht_context_t pop_temp_ctx = {
-        temp_file_hts_for_lookup[i], 0
-      };
-      if (holdall_apply_context(file_holdalls[i], &pop_temp_ctx,
-          hgo_populate_temp_ht_pass_ctx, hgo_populate_temp_ht_add_word) != 0
-          || pop_temp_ctx.error_flag) {
-        fprintf(stderr,
-            "Error: Failed to populate temp lookup HT for file %s.\n",
-            filenames_in_order[i]);
-        goto cleanup_graph_all_resources;
+      if (d <= max_distance) {
+        output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+      }
+    }
+  }
+  outbuf_dispose(&out);
+  if (unchanged) {
+    return 0;
+  }
+  if (w == nullptr || corpusindex_writer_commit(&w) != 0) {
+    fprintf(stderr, "jdis: Cannot write index '%s'.\n", index_filename);
+    return -1;
+  }
+  return 0;
+}
+
+void handle_minhash_output(minhash **signatures, size_t num_files,
+    char **filenames_in_order, float max_distance) {
+  outbuf *out = output_open();
+  if (out == nullptr) {
+    return;
+  }
+  for (size_t j = 0; j < num_files; ++j) {
+    for (size_t k = j + 1; k < num_files; ++k) {
+      float d = minhash_distance(signatures[j], signatures[k]);
+      if (d <= max_distance) {
+        output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+      }
+    }
+  }
+  outbuf_dispose(&out);
+}
+
+int handle_lsh_output(wordset **file_sets, minhash **signatures,
+    size_t num_files, char **filenames_in_order, size_t bands,
+    float max_distance) {
+  lsh_pair *pairs;
+  size_t num_pairs;
+  if (lsh_candidate_pairs(signatures, num_files, bands, &pairs, &num_pairs)
+      != 0) {
+    fprintf(stderr, "Error: Failed to allocate LSH candidate pairs.\n");
+    return -1;
+  }
+  outbuf *out = output_open();
+  if (out == nullptr) {
+    free(pairs);
+    return -1;
+  }
+  for (size_t p = 0; p < num_pairs; ++p) {
+    size_t j = pairs[p].first;
+    size_t k = pairs[p].second;
+    float d = jaccard_distance(file_sets[j], file_sets[k]);
+    if (d <= max_distance) {
+      output_pair(out, d, filenames_in_order[j], filenames_in_order[k]);
+    }
+  }
+  free(pairs);
+  outbuf_dispose(&out);
+  return 0;
+}
+
+void jdis_dispose_minhash_array(minhash **mh_array, size_t count) {
+  if (mh_array == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    minhash_dispose(&mh_array[i]);
+  }
+  free(mh_array);
+}
+
+void jdis_dispose_record_array(jdis_file_record *records, size_t count) {
+  if (records == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    free(records[i].truncated_text);
+  }
+  free(records);
+}
+
+void jdis_dispose_wordset_array(wordset **ws_array, size_t count) {
+  if (ws_array == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    wordset_dispose(&ws_array[i]);
+  }
+  free(ws_array);
+}
+
+//  hgo_entry_t : entrée du vocabulaire trié en mode graphique, associant un
+//    mot à son identifiant.
+//    Membres :
+//      word : le mot.
+//      id : l'identifiant du mot.
+typedef struct {
+  const char *word;
+  uint32_t id;
+} hgo_entry_t;
+
+//  hgo_compute_keys : affecte à chacun des num_entries éléments du tableau
+//    items la clé de collation du mot de l'entrée qu'il référence. L'ordre de
+//    strsort sur les clés est celui de strcoll sur les mots. Lorsque la
+//    catégorie LC_COLLATE de la locale courante est C ou POSIX, la clé d'un
+//    mot est le mot lui-même ; elle est sinon calculée par strxfrm, une fois
+//    pour toutes, et rangée dans une arène dont l'adresse est affectée à
+//    *keysptr. Renvoie 0 en cas de succès, -1 en cas d'erreur d'allocation.
+static int hgo_compute_keys(strsort_item *items, size_t num_entries,
+    arena **keysptr) {
+  *keysptr = nullptr;
+  const char *collate = setlocale(LC_COLLATE, nullptr);
+  if (collate == nullptr || strcmp(collate, "C") == 0
+      || strcmp(collate, "POSIX") == 0) {
+    for (size_t k = 0; k < num_entries; ++k) {
+      const hgo_entry_t *entry = items[k].ref;
+      items[k].key = entry->word;
+      items[k].length = strlen(entry->word);
+    }
+    return 0;
+  }
+  arena *keys = arena_empty();
+  size_t capacity = 256;
+  char *buffer = malloc(capacity);
+  if (keys == nullptr || buffer == nullptr) {
+    goto error;
+  }
+  for (size_t k = 0; k < num_entries; ++k) {
+    const hgo_entry_t *entry = items[k].ref;
+    size_t length = strxfrm(buffer, entry->word, capacity);
+    if (length >= capacity) {
+      free(buffer);
+      capacity = length + 1;
+      buffer = malloc(capacity);
+      if (buffer == nullptr) {
+        goto error;
       }
+      strxfrm(buffer, entry->word, capacity);
+    }
+    items[k].key = arena_strndup(keys, buffer, length);
+    if (items[k].key == nullptr) {
+      goto error;
+    }
+    items[k].length = length;
+  }
+  free(buffer);
+  *keysptr = keys;
+  return 0;
+error:
+  free(buffer);
+  arena_dispose(&keys);
+  return -1;
+}
+
+//  hgo_cursor_t : curseur de la fusion sur les mots d'un fichier.
+//    Membres :
+//      ranks : rangs dans le vocabulaire trié des mots du fichier, en ordre
+//              croissant.
+//      count : nombre de mots du fichier.
+//      next : indice du prochain rang à fusionner.
+typedef struct {
+  uint32_t *ranks;
+  size_t count;
+  size_t next;
+} hgo_cursor_t;
+
+//  hgo_head : renvoie le prochain rang à fusionner du curseur pointé par c,
+//    qui n'est pas épuisé.
+static inline uint32_t hgo_head(const hgo_cursor_t *c) {
+  return c->ranks[c->next];
+}
+
+//  hgo_sift_down : rétablit la propriété de tas-min, selon le prochain rang à
+//    fusionner des curseurs du tableau cursors, du tas de n numéros de
+//    fichiers heap dont seul l'élément d'indice i est éventuellement mal
+//    placé.
+static void hgo_sift_down(size_t *heap, size_t n, size_t i,
+    const hgo_cursor_t *cursors) {
+  size_t f = heap[i];
+  uint32_t r = hgo_head(&cursors[f]);
+  while (2 * i + 1 < n) {
+    size_t c = 2 * i + 1;
+    if (c + 1 < n
+        && hgo_head(&cursors[heap[c + 1]]) < hgo_head(&cursors[heap[c]])) {
+      ++c;
     }
+    if (hgo_head(&cursors[heap[c]]) >= r) {
+      break;
+    }
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = f;
+}
+
+//  hgo_merge : écrit au moyen de out les lignes de la sortie graphique des
+//    num_files fichiers dont les curseurs sont rangés dans cursors, le mot de
+//    rang r du vocabulaire trié étant words[r]. Les curseurs sont fusionnés
+//    par un tas-min de leurs prochains rangs : chaque ligne rassemble les
+//    fichiers dont le prochain rang est le plus petit, puis fait avancer leurs
+//    curseurs. heap et marked sont des tableaux de num_files éléments et row
+//    un tampon de 2 * num_files + 1 octets, à l'usage de la fonction.
+static void hgo_merge(hgo_cursor_t *cursors, size_t num_files,
+    const char * const *words, size_t *heap, size_t *marked, char *row,
+    outbuf *out) {
+  size_t n = 0;
+  for (size_t j = 0; j < num_files; ++j) {
+    row[2 * j] = '\t';
+    row[2 * j + 1] = '-';
+    if (cursors[j].count > 0) {
+      heap[n] = j;
+      ++n;
+    }
+  }
+  row[2 * num_files] = '\n';
+  for (size_t i = n / 2; i > 0; --i) {
+    hgo_sift_down(heap, n, i - 1, cursors);
+  }
+  while (n > 0) {
+    uint32_t r = hgo_head(&cursors[heap[0]]);
+    size_t m = 0;
+    do {
+      size_t f = heap[0];
+      row[2 * f + 1] = 'x';
+      marked[m] = f;
+      ++m;
+      cursors[f].next += 1;
+      if (cursors[f].next == cursors[f].count) {
+        --n;
+        heap[0] = heap[n];
+      }
+      if (n > 0) {
+        hgo_sift_down(heap, n, 0, cursors);
+      }
+    } while (n > 0 && hgo_head(&cursors[heap[0]]) == r);
+    outbuf_puts(out, words[r]);
+    outbuf_write(out, row, 2 * num_files + 1);
+    for (size_t k = 0; k < m; ++k) {
+      row[2 * marked[k] + 1] = '-';
+    }
+  }
+}
+
+void handle_graph_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, int initial_letters_limit,
+    size_t num_threads) {
+  (void) initial_letters_limit;
+  size_t vocabulary_size = lexicon_count(lx);
+  bool *is_in_union = calloc(vocabulary_size + 1, sizeof *is_in_union);
+  hgo_entry_t *entries = malloc((vocabulary_size + 1) * sizeof *entries);
+  strsort_item *items = malloc((vocabulary_size + 1) * sizeof *items);
+  arena *collation_keys = nullptr;
+  const char **words = nullptr;
+  uint32_t *ranks = nullptr;
+  hgo_cursor_t *cursors = calloc(num_files + 1, sizeof *cursors);
+  size_t *heap = malloc((num_files + 1) * sizeof *heap);
+  size_t *marked = malloc((num_files + 1) * sizeof *marked);
+  char *row = malloc(2 * num_files + 1);
+  outbuf *out = nullptr;
+  if (is_in_union == nullptr || entries == nullptr || items == nullptr
+      || cursors == nullptr || heap == nullptr || marked == nullptr
+      || row == nullptr) {
+    fprintf(stderr,
+        "Error: Failed to allocate memory for vocabulary in graph mode.\n");
+    goto cleanup_graph_all_resources;
   }
-#if defined HOLDALL_EXT && defined WANT_HOLDALL_EXT
-  holdall_sort(all_unique_words_ha, compare_strings_for_qsort);
-#else
-  fprintf(stderr,
-      "Warning: holdall_sort not available. Graph output will not be sorted by word.\n");
-#endif
-  printf("\t");
   for (size_t i = 0; i < num_files; ++i) {
-    printf("%s", filenames_in_order[i]);
+    if (file_sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(file_sets[i]);
+    for (size_t k = 0; k < wordset_count(file_sets[i]); ++k) {
+      is_in_union[ids[k]] = true;
+    }
+  }
+  size_t num_entries = 0;
+  for (uint32_t id = 0; id < vocabulary_size; ++id) {
+    if (is_in_union[id]) {
+      entries[num_entries] = (hgo_entry_t) {
+        lexicon_word(lx, id), id
+      };
+      items[num_entries].ref = &entries[num_entries];
+      ++num_entries;
+    }
+  }
+  if (hgo_compute_keys(items, num_entries, &collation_keys) != 0) {
+    fprintf(stderr,
+        "Error: Failed to compute collation keys for graph mode.\n");
+    goto cleanup_graph_all_resources;
+  }
+  strsort(items, num_entries, num_threads);
+  //  Seuls le mot de chaque rang et le rang de chaque identifiant sont
+  //    conservés pour la fusion.
+  words = malloc((num_entries + 1) * sizeof *words);
+  ranks = malloc((vocabulary_size + 1) * sizeof *ranks);
+  if (words == nullptr || ranks == nullptr) {
+    fprintf(stderr,
+        "Error: Failed to allocate memory for vocabulary in graph mode.\n");
+    goto cleanup_graph_all_resources;
+  }
+  for (size_t r = 0; r < num_entries; ++r) {
+    const hgo_entry_t *entry = items[r].ref;
+    words[r] = entry->word;
+    ranks[entry->id] = (uint32_t) r;
+  }
+  arena_dispose(&collation_keys);
+  free(items);
+  items = nullptr;
+  free(entries);
+  entries = nullptr;
+  free(is_in_union);
+  is_in_union = nullptr;
+  for (size_t i = 0; i < num_files; ++i) {
+    if (file_sets[i] == nullptr || wordset_count(file_sets[i]) == 0) {
+      continue;
+    }
+    size_t count = wordset_count(file_sets[i]);
+    cursors[i].ranks = malloc(count * sizeof *cursors[i].ranks);
+    if (cursors[i].ranks == nullptr) {
+      fprintf(stderr, "Error: Failed to sort the words of file %s.\n",
+          filenames_in_order[i]);
+      goto cleanup_graph_all_resources;
+    }
+    const uint32_t *ids = wordset_ids(file_sets[i]);
+    for (size_t k = 0; k < count; ++k) {
+      cursors[i].ranks[k] = ranks[ids[k]];
+    }
+    qsort(cursors[i].ranks, count, sizeof *cursors[i].ranks,
+        compare_word_ids);
+    cursors[i].count = count;
+  }
+  out = output_open();
+  if (out == nullptr) {
+    goto cleanup_graph_all_resources;
+  }
+  outbuf_putc(out, '\t');
+  for (size_t i = 0; i < num_files; ++i) {
+    outbuf_puts(out, filenames_in_order[i]);
     if (i < num_files - 1) {
-      printf("\t");
+      outbuf_putc(out, '\t');
     }
   }
-  printf("\n");
-  hgo_graph_print_row_context_t actual_print_context = {
-    temp_file_hts_for_lookup, num_files, filenames_in_order
-  };
-  holdall_apply_context(all_unique_words_ha, &actual_print_context,
-      pass_context_identity, print_row_via_fun2);
+  outbuf_putc(out, '\n');
+  hgo_merge(cursors, num_files, words, heap, marked, row, out);
 cleanup_graph_all_resources:
-  if (temp_file_hts_for_lookup != nullptr) {
+  if (cursors != nullptr) {
     for (size_t i = 0; i < num_files; ++i) {
-      if (temp_file_hts_for_lookup[i] != nullptr) {
-        hashtable_dispose(&temp_file_hts_for_lookup[i]);
-      }
+      free(cursors[i].ranks);
     }
-    free(temp_file_hts_for_lookup);
+    free(cursors);
   }
-cleanup_graph_main_resources:
-  holdall_dispose(&all_unique_words_ha);
-  hashtable_dispose(&master_word_registry_ht);
+  outbuf_dispose(&out);
+  arena_dispose(&collation_keys);
+  free(row);
+  free(marked);
+  free(heap);
+  free(ranks);
+  free(words);
+  free(items);
+  free(entries);
+  free(is_in_union);
 }
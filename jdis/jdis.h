@@ -9,65 +9,272 @@
 //    de présence des mots.
 //  - Les mots peuvent être tronqués à une certaine longueur initiale.
 //  - La ponctuation peut être traitée comme un séparateur de mots.
+//  - Les mots de tous les fichiers sont internés dans un même dictionnaire
+//    (voir lexicon.h) : l'ensemble des mots d'un fichier est une collection
+//    d'identifiants entiers (voir wordset.h).
 
 #ifndef JDIS__H
 #define JDIS__H
 
+#include "corpusindex.h"
 #include "hashtable.h"
-#include "holdall.h"
+#include "lexicon.h"
+#include "minhash.h"
+#include "wordcache.h"
+#include "wordset.h"
 #include <stdbool.h>
+#include <sys/stat.h>
+
+//  jdis_file_record : informations sur la lecture d'un fichier du corpus
+//    nécessaires à l'écriture d'un index (voir corpusindex.h).
+//    Membres :
+//      slot : rang du fichier dans l'index dont ses mots ont été tirés, ou
+//             CORPUSINDEX_NONE s'il a été lu.
+//      indexable : indique si le fichier est un fichier ordinaire, auquel cas
+//                  st est son identité avant sa lecture.
+//      truncated_text : mots tronqués lors de la lecture, chacun suivi d'un
+//                       caractère nul, ou nullptr. L'index les mémorise au
+//                       lieu du texte des avertissements, qui mentionne le
+//                       nom sous lequel le fichier a été désigné.
+//      truncated_length : longueur de truncated_text.
+typedef struct {
+  size_t slot;
+  bool indexable;
+  struct stat st;
+  char *truncated_text;
+  size_t truncated_length;
+} jdis_file_record;
 
 //  get_words : lit un fichier et en extrait les mots uniques.
-//    Les mots sont stockés dans un holdall. La fonction gère la lecture
-//    depuis stdin si filename est "-".
+//    Les mots sont internés dans le dictionnaire lx et leurs identifiants
+//    sont stockés dans un wordset. La fonction gère la lecture depuis stdin si
+//    filename est "-".
 //    Paramètres :
 //      filename : le nom du fichier à lire ("-" pour stdin).
+//      lx : le dictionnaire partagé par tous les fichiers du corpus.
+//      signature : signature MinHash mise à jour avec chacun des mots uniques
+//                  du fichier, ou nullptr.
 //      initial_letters_limit : nombre de lettres initiales à considérer
 //                               pour chaque mot (0 = pas de limite).
 //      punctuation_as_space : si true, traite la ponctuation comme des
 //                               espaces séparateurs.
-//    Renvoie : un pointeur vers un holdall contenant les mots uniques (chaînes
-//              allouées dynamiquement), ou nullptr en cas d'erreur.
-extern holdall *get_words(const char *filename, int initial_letters_limit,
-    bool punctuation_as_space);
+//    Renvoie : un pointeur vers un wordset trié contenant les identifiants des
+//              mots uniques, ou nullptr en cas d'erreur.
+extern wordset *get_words(const char *filename, lexicon *lx,
+    minhash *signature, int initial_letters_limit, bool punctuation_as_space);
+
+//  get_corpus_words : lit les num_files fichiers dont les noms figurent dans
+//    le tableau filenames, à la manière de get_words. Si num_threads est
+//    strictement supérieur à 1, les fichiers sont lus par num_threads fils
+//    d'exécution au plus ; les mots sont toutefois internés dans lx, et les
+//    messages d'erreur et d'avertissement écrits sur la sortie erreur, dans
+//    l'ordre des fichiers, de sorte que le résultat ne dépend pas du nombre
+//    de fils.
+//    Paramètres :
+//      signatures : tableau des signatures MinHash des fichiers, ou nullptr.
+//      cache : cache des mots distincts des fichiers (voir wordcache.h), ou
+//              nullptr. Les mots d'un fichier ordinaire dont l'entrée est
+//              valide sont tirés de celle-ci, les messages émis lors de sa
+//              lecture étant répétés ; l'entrée est sinon écrite après la
+//              lecture du fichier.
+//      index : index chargé (voir corpusindex.h), ou nullptr. Les mots d'un
+//              fichier ordinaire qui y figure sous le même nom et avec la
+//              même identité sont tirés de celui-ci, les messages émis lors
+//              de sa lecture étant répétés ; le cache n'est alors pas
+//              consulté.
+//      records : tableau dans lequel sont rangées les informations sur la
+//                lecture de chaque fichier, ou nullptr.
+//      file_sets : tableau dans lequel est rangé le wordset de chaque
+//                  fichier, ou nullptr si les ensembles ne sont pas
+//                  conservés.
+//    Renvoie : le nombre de fichiers lus avec succès avant le premier échec,
+//              c'est-à-dire num_files en cas de succès.
+extern size_t get_corpus_words(char **filenames, size_t num_files,
+    lexicon *lx, minhash **signatures, int initial_letters_limit,
+    bool punctuation_as_space, size_t num_threads, wordcache *cache,
+    const corpusindex *index, jdis_file_record *records, wordset **file_sets);
 
 //  jaccard_distance : calcule la dissimilarité de Jaccard entre deux ensembles
 //    de mots.
 //    Paramètres :
-//      ha1 : holdall contenant les mots du premier ensemble.
-//      ha2 : holdall contenant les mots du second ensemble.
+//      ws1 : wordset trié contenant les identifiants du premier ensemble.
+//      ws2 : wordset trié contenant les identifiants du second ensemble.
 //    Renvoie : la dissimilarité de Jaccard (entre 0.0 et 1.0). Renvoie 1.0f si
-//              l'un des holdalls est nullptr ou en cas d'erreur d'allocation
-// mémoire
-//              interne. Renvoie 0.0f si les deux ensembles sont vides.
-extern float jaccard_distance(holdall *ha1, holdall *ha2);
-
-//  jdis_free_holdall_content : libère la mémoire des chaînes de caractères
-//    (mots) stockées dans un holdall.
-//    Suppose que les éléments du holdall sont des char* alloués avec
-// strdup/malloc.
+//              l'un des wordsets est nullptr. Renvoie 0.0f si les deux
+//              ensembles sont vides. Le calcul n'effectue aucune allocation.
+extern float jaccard_distance(const wordset *ws1, const wordset *ws2);
+
+//  jdis_engine : moteur de calcul des dissimilarités de tous les couples de
+//    fichiers.
+//      JDIS_ENGINE_AUTO : choix du moteur de moindre coût estimé, selon la
+//                         taille du vocabulaire, le cardinal moyen des
+//                         ensembles de mots et la fréquence des mots.
+//      JDIS_ENGINE_MERGE : intersection par fusion des ensembles triés, couple
+//                          par couple (voir wordset.h).
+//      JDIS_ENGINE_BITSET : matrice binaire fichiers × mots et comptage par
+//                           blocs des bits communs (voir bitmatrix.h).
+//      JDIS_ENGINE_INDEX : index inversé mots × fichiers et comptage par
+//                          parcours des listes des mots (voir postings.h).
+//      JDIS_ENGINE_JOIN : jointure par similarité, qui ne calcule que les
+//                         dissimilarités des couples pouvant ne pas dépasser
+//                         la dissimilarité maximale (voir simjoin.h) ; la
+//                         fusion est utilisée si celle-ci vaut au moins 1.
+typedef enum {
+  JDIS_ENGINE_AUTO,
+  JDIS_ENGINE_MERGE,
+  JDIS_ENGINE_BITSET,
+  JDIS_ENGINE_INDEX,
+  JDIS_ENGINE_JOIN,
+} jdis_engine;
+
+//  handle_pairs_output : affiche, pour chaque couple de fichiers (j, k) avec
+//    j < k et dans l'ordre lexicographique des couples, la dissimilarité de
+//    Jaccard de leurs ensembles de mots avec quatre décimales, suivie des noms
+//    des deux fichiers.
+//    Paramètres :
+//      file_sets : tableau de wordsets triés, chacun contenant les
+//                  identifiants des mots d'un fichier.
+//      num_files : nombre de fichiers (et donc de wordsets).
+//      filenames_in_order : tableau des noms de fichiers, dans l'ordre.
+//      lx : le dictionnaire dans lequel les mots des fichiers ont été
+//           internés.
+//      engine : le moteur de calcul demandé. Si la matrice binaire, l'index
+//               inversé ou l'index de la jointure ne peut être alloué, le
+//               moteur par fusion est utilisé.
+//      max_distance : seuls les couples de dissimilarité au plus égale à
+//                     max_distance sont affichés.
+//      num_threads : nombre de fils d'exécution calculant les
+//                    dissimilarités. Le triangle des couples est découpé en
+//                    tuiles réparties à la demande entre les fils ; l'affichage
+//                    se fait dans l'ordre des couples, par bandes de lignes,
+//                    au fur et à mesure de leur achèvement.
+extern void handle_pairs_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, jdis_engine engine,
+    float max_distance, size_t num_threads);
+
+//  handle_top_output : affiche, pour chaque fichier dans l'ordre, au plus k
+//    lignes à la manière de handle_pairs_output, la première colonne de
+//    fichiers étant ce fichier et la seconde ses plus proches voisins, par
+//    dissimilarité croissante puis dans l'ordre des fichiers. Les fichiers
+//    sont parcourus par cardinal croissant de leurs ensembles, de part et
+//    d'autre du fichier considéré, et le parcours s'arrête dès que le minorant
+//    1 - min / max de la dissimilarité tiré des cardinaux dépasse la plus
+//    grande dissimilarité retenue, de sorte que la plupart des couples ne
+//    sont pas comparés.
+//    Paramètres :
+//      file_sets : tableau de wordsets triés, chacun contenant les
+//                  identifiants des mots d'un fichier.
+//      num_files : nombre de fichiers (et donc de wordsets), au moins 2.
+//      filenames_in_order : tableau des noms de fichiers, dans l'ordre.
+//      lx : le dictionnaire dans lequel les mots des fichiers ont été
+//           internés.
+//      engine : le moteur de calcul des dissimilarités, choisi comme pour
+//               handle_pairs_output ; la matrice binaire sert alors au
+//               comptage des mots communs de chaque couple comparé.
+//      k : nombre maximal de voisins d'un fichier, au moins 1.
+//      max_distance : seuls les voisins de dissimilarité au plus égale à
+//                     max_distance sont retenus.
+//      num_threads : nombre de fils d'exécution cherchant les voisins,
+//                    répartis par tranches de fichiers.
+//    Renvoie : 0 en cas de succès, -1 en cas d'erreur d'allocation.
+extern int handle_top_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, jdis_engine engine,
+    size_t k, float max_distance, size_t num_threads);
+
+//  handle_indexed_pairs_output : comme handle_pairs_output, mais en tirant de
+//    l'index index la dissimilarité de tout couple de fichiers qui y figurent
+//    tous deux, seule celle des couples formés avec un fichier nouveau ou
+//    modifié étant calculée, puis en écrivant à la place du fichier
+//    index_filename l'index des fichiers et des dissimilarités de tous leurs
+//    couples. L'écriture, en O(N²) pour N fichiers, n'a lieu que si la liste
+//    des fichiers diffère de celle de l'index : fichier nouveau, modifié,
+//    retiré ou déplacé, ou fichier qui n'est pas un fichier ordinaire.
+//    Paramètres :
+//      index : index chargé, ou nullptr.
+//      records : tableau des informations sur la lecture des fichiers tel
+//                que l'a rempli get_corpus_words.
+//      index_filename : nom du fichier de l'index.
+//      initial_letters_limit, punctuation_as_space : options de lecture
+//                                                    mémorisées par l'index.
+//    Renvoie : 0 en cas de succès, -1 si l'index ne peut être écrit ou en
+//              cas d'erreur d'allocation.
+extern int handle_indexed_pairs_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, const corpusindex *index,
+    const jdis_file_record *records, const char *index_filename,
+    int initial_letters_limit, bool punctuation_as_space, float max_distance);
+
+//  handle_minhash_output : comme handle_pairs_output, mais avec les
+//    estimations des dissimilarités tirées des signatures MinHash des
+//    fichiers.
+//    Paramètres :
+//      signatures : tableau des signatures, toutes de même taille.
+//      num_files : nombre de fichiers (et donc de signatures).
+//      filenames_in_order : tableau des noms de fichiers, dans l'ordre.
+//      max_distance : seuls les couples d'estimation au plus égale à
+//                     max_distance sont affichés.
+extern void handle_minhash_output(minhash **signatures, size_t num_files,
+    char **filenames_in_order, float max_distance);
+
+//  handle_lsh_output : comme handle_pairs_output, mais en se limitant aux
+//    couples candidats désignés par le hachage sensible à la localité des
+//    signatures MinHash des fichiers (voir lsh.h). La dissimilarité d'un
+//    couple affiché est celle que calcule jaccard_distance.
+//    Paramètres :
+//      file_sets : tableau de wordsets triés, chacun contenant les
+//                  identifiants des mots d'un fichier.
+//      signatures : tableau des signatures, toutes de même taille K.
+//      num_files : nombre de fichiers (et donc de wordsets et de signatures).
+//      filenames_in_order : tableau des noms de fichiers, dans l'ordre.
+//      bands : nombre de bandes des signatures, entre 1 et K.
+//      max_distance : seuls les couples de dissimilarité au plus égale à
+//                     max_distance sont affichés.
+//    Renvoie : 0 en cas de succès, -1 en cas d'erreur d'allocation.
+extern int handle_lsh_output(wordset **file_sets, minhash **signatures,
+    size_t num_files, char **filenames_in_order, size_t bands,
+    float max_distance);
+
+//  jdis_dispose_minhash_array : libère un tableau de signatures, y compris
+//    chaque signature et le tableau lui-même.
+//    Paramètres :
+//      mh_array : le tableau de pointeurs vers des signatures.
+//      count : le nombre d'éléments dans mh_array.
+extern void jdis_dispose_minhash_array(minhash **mh_array, size_t count);
+
+//  jdis_dispose_wordset_array : libère un tableau de wordsets, y compris
+//    chaque wordset et le tableau lui-même.
 //    Paramètres :
-//      ha : le holdall dont le contenu doit être libéré.
-extern void jdis_free_holdall_content(holdall *ha);
+//      ws_array : le tableau de pointeurs vers des wordsets.
+//      count : le nombre d'éléments dans ws_array.
+extern void jdis_dispose_wordset_array(wordset **ws_array, size_t count);
 
-//  jdis_dispose_holdall_array : libère un tableau de holdalls, y compris
-//    le contenu de chaque holdall et le tableau lui-même.
+//  jdis_dispose_record_array : libère un tableau d'informations sur la
+//    lecture de fichiers, y compris le texte des messages de chacun et le
+//    tableau lui-même.
 //    Paramètres :
-//      ha_array : le tableau de pointeurs vers des holdalls.
-//      count : le nombre d'éléments dans ha_array.
-extern void jdis_dispose_holdall_array(holdall **ha_array, size_t count);
+//      records : le tableau d'informations, ou nullptr.
+//      count : le nombre d'éléments dans records.
+extern void jdis_dispose_record_array(jdis_file_record *records,
+    size_t count);
 
 //  handle_graph_output : génère et affiche la sortie graphique indiquant la
 //    présence ou l'absence de chaque mot unique dans les fichiers fournis.
+//    Le vocabulaire est trié une fois pour toutes (voir strsort.h) ; les
+//    lignes sont ensuite produites par fusion, au moyen d'un tas, des listes
+//    triées des rangs des mots de chaque fichier.
 //    Paramètres :
-//      file_holdalls : tableau de holdalls, chacun contenant les mots d'un
-// fichier.
-//      num_files : nombre de fichiers (et donc de holdalls).
+//      file_sets : tableau de wordsets, chacun contenant les identifiants des
+//                  mots d'un fichier.
+//      num_files : nombre de fichiers (et donc de wordsets).
 //      filenames_in_order : tableau des noms de fichiers, dans l'ordre.
+//      lx : le dictionnaire dans lequel les mots des fichiers ont été
+//           internés.
 //      initial_letters_limit : limite sur le nombre de lettres initiales des
 // mots (non utilisé directement ici, mais contextuel).
-extern void handle_graph_output(holdall **file_holdalls, size_t num_files,
-    char **filenames_in_order, int initial_letters_limit);
+//      num_threads : nombre de fils d'exécution triant le vocabulaire (voir
+//                    strsort.h).
+extern void handle_graph_output(wordset **file_sets, size_t num_files,
+    char **filenames_in_order, const lexicon *lx, int initial_letters_limit,
+    size_t num_threads);
 
 //  print_usage : affiche un message bref sur l'utilisation du programme.
 extern void print_usage(void);
@@ -0,0 +1,408 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "corpusgen.h"
+#include "lexicon.h"
+#include "wordset.h"
+#include "jdis.h"
+
+//  Mesure des performances de jdis sur un corpus synthétique reproductible
+//    (voir corpusgen.h). Le corpus est écrit dans un répertoire temporaire,
+//    supprimé à la fin, ou dans le répertoire donné par -d, où il est
+//    conservé. Sont ensuite chronométrées séparément :
+//  - la lecture des fichiers par get_words, en un seul fil ;
+//  - le calcul par jaccard_distance des dissimilarités de tous les couples ;
+//  - la sortie graphique par handle_graph_output, redirigée vers un fichier
+//    du répertoire du corpus, supprimé à la fin.
+//  Les résultats sont écrits sur la sortie standard, précédés d'une ligne de
+//    commentaire rappelant les paramètres, en colonnes séparées par des
+//    tabulations dont la première ligne donne les noms :
+//      phase : get_words, jaccard_distance ou handle_graph_output ;
+//      files : nombre de fichiers ;
+//      words : mots lus pour get_words, somme des cardinaux des deux ensembles
+//        de chaque couple pour jaccard_distance, mots distincts du corpus pour
+//        handle_graph_output ;
+//      bytes : octets lus pour get_words, écrits pour handle_graph_output, 0
+//        pour jaccard_distance ;
+//      pairs : nombre de couples pour jaccard_distance, 0 sinon ;
+//      seconds : durée de la phase ;
+//      words_per_s, mb_per_s, pairs_per_s : débits, le mégaoctet valant 10⁶
+//        octets.
+
+//  BENCH_NAME_FORMAT : format des noms des fichiers du corpus.
+#define BENCH_NAME_FORMAT "%s/f%06zu.txt"
+
+//  BENCH_GRAPH_NAME : nom du fichier recevant la sortie graphique.
+#define BENCH_GRAPH_NAME "graph.out"
+
+//  bench_options : paramètres d'une mesure.
+//    Membres :
+//      corpus : paramètres du corpus.
+//      num_files : nombre de fichiers du corpus.
+//      num_jobs : nombre de fils d'exécution de la sortie graphique.
+//      punctuation_as_space : si true, la ponctuation est traitée comme des
+//                             espaces séparateurs.
+//      directory : répertoire où conserver le corpus, ou nullptr.
+typedef struct {
+  corpusgen_params corpus;
+  size_t num_files;
+  size_t num_jobs;
+  bool punctuation_as_space;
+  const char *directory;
+} bench_options;
+
+//  print_bench_help : affiche un message d'aide sur l'utilisation du
+//    programme.
+static void print_bench_help(void) {
+  printf("Usage: jdis_bench [OPTION]...\n\n");
+  printf("Generate a reproducible synthetic corpus and time the reading of its"
+      " files\n(get_words), the Jaccard distances of all its pairs"
+      " (jaccard_distance) and\nits graph output (handle_graph_output)."
+      " Results are written as\ntab-separated columns.\n\n");
+  printf("  -n, --files=N                number of files (default 100)\n");
+  printf("  -w, --file-words=N           words per file (default 5000)\n");
+  printf("  -v, --vocabulary=N           vocabulary size (default 20000)\n");
+  printf("  -z, --zipf=S                 Zipf exponent of word frequencies"
+      " (default 1)\n");
+  printf("  -l, --word-length=N          mean word length (default 7)\n");
+  printf("  -P, --punctuation-density=X  probability that a word is followed"
+      " by a\n                               punctuation mark (default"
+      " 0.05)\n");
+  printf("  -s, --seed=N                 random seed (default 1)\n");
+  printf("  -j, --jobs=N                 threads sorting the graph vocabulary"
+      " (default 1)\n");
+  printf("  -p, --punctuation-like-space treat punctuation as spaces\n");
+  printf("  -d, --directory=DIR          write the corpus into the existing"
+      " directory DIR\n                               and keep it\n");
+  printf("  -?, --help                   display this help and exit\n");
+}
+
+//  parse_u64 : affecte à *value l'entier naturel dont l'écriture décimale est
+//    la chaîne s s'il est compris entre min et max. Renvoie une valeur non
+//    nulle si s n'est pas l'écriture d'un tel entier. Renvoie sinon zéro.
+static int parse_u64(const char *s, uint64_t min, uint64_t max,
+    uint64_t *value) {
+  char *endptr;
+  errno = 0;
+  unsigned long long val = strtoull(s, &endptr, 10);
+  if (endptr == s || *endptr != '\0' || errno == ERANGE || s[0] == '-'
+      || val < min || val > max) {
+    return -1;
+  }
+  *value = (uint64_t) val;
+  return 0;
+}
+
+//  parse_size : comme parse_u64, pour un entier de type size_t.
+static int parse_size(const char *s, size_t min, size_t max, size_t *value) {
+  uint64_t val;
+  if (parse_u64(s, min, max, &val) != 0) {
+    return -1;
+  }
+  *value = (size_t) val;
+  return 0;
+}
+
+//  parse_real : affecte à *value le nombre dont l'écriture décimale est la
+//    chaîne s s'il est compris entre 0 et max. Renvoie une valeur non nulle si
+//    s n'est pas l'écriture d'un tel nombre. Renvoie sinon zéro.
+static int parse_real(const char *s, double max, double *value) {
+  char *endptr;
+  errno = 0;
+  double val = strtod(s, &endptr);
+  if (endptr == s || *endptr != '\0' || errno == ERANGE || !(val >= 0.0)
+      || val > max) {
+    return -1;
+  }
+  *value = val;
+  return 0;
+}
+
+//  option_value : si argv[*i] est l'option courte short_name, affecte à
+//    *value l'argument suivant et incrémente *i ; si argv[*i] commence par
+//    long_name, de la forme "--nom=", affecte à *value la suite de argv[*i].
+//    Renvoie 1 dans ces deux cas, -1 si l'option courte n'est suivie d'aucun
+//    argument, 0 si argv[*i] n'est pas l'option.
+static int option_value(int argc, char *argv[], int *i,
+    const char *short_name, const char *long_name, const char **value) {
+  if (strcmp(argv[*i], short_name) == 0) {
+    if (*i + 1 >= argc) {
+      fprintf(stderr, "jdis_bench: Option %s requires a value.\n", short_name);
+      return -1;
+    }
+    *i += 1;
+    *value = argv[*i];
+    return 1;
+  }
+  if (strncmp(argv[*i], long_name, strlen(long_name)) == 0) {
+    *value = argv[*i] + strlen(long_name);
+    return 1;
+  }
+  return 0;
+}
+
+//  parse_options : analyse les argc - 1 arguments de argv et affecte les
+//    paramètres correspondants à *options. Renvoie 0 en cas de succès, 1 si
+//    l'aide a été demandée, -1 en cas d'argument invalide.
+static int parse_options(int argc, char *argv[], bench_options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *option = argv[i];
+    const char *value = nullptr;
+    int r;
+    int invalid = 0;
+    if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-?") == 0) {
+      return 1;
+    } else if (strcmp(argv[i], "-p") == 0
+        || strcmp(argv[i], "--punctuation-like-space") == 0) {
+      options->punctuation_as_space = true;
+    } else if ((r = option_value(argc, argv, &i, "-n", "--files=", &value))
+        != 0) {
+      invalid = r < 0
+          || parse_size(value, 2, SIZE_MAX, &options->num_files) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-w", "--file-words=",
+        &value)) != 0) {
+      invalid = r < 0 || parse_size(value, 0, SIZE_MAX,
+          &options->corpus.file_words) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-v", "--vocabulary=",
+        &value)) != 0) {
+      invalid = r < 0 || parse_size(value, 1, SIZE_MAX,
+          &options->corpus.vocabulary) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-z", "--zipf=", &value))
+        != 0) {
+      invalid = r < 0
+          || parse_real(value, 100.0, &options->corpus.zipf) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-l", "--word-length=",
+        &value)) != 0) {
+      invalid = r < 0 || parse_size(value, 1, 1024,
+          &options->corpus.word_length) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-P",
+        "--punctuation-density=", &value)) != 0) {
+      invalid = r < 0
+          || parse_real(value, 1.0, &options->corpus.punctuation) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-s", "--seed=", &value))
+        != 0) {
+      invalid = r < 0 || parse_u64(value, 0, UINT64_MAX,
+          &options->corpus.seed) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-j", "--jobs=", &value))
+        != 0) {
+      invalid = r < 0
+          || parse_size(value, 1, 1024, &options->num_jobs) != 0;
+    } else if ((r = option_value(argc, argv, &i, "-d", "--directory=",
+        &value)) != 0) {
+      invalid = r < 0;
+      options->directory = value;
+    } else {
+      fprintf(stderr, "jdis_bench: Unknown option '%s'.\n", argv[i]);
+      return -1;
+    }
+    if (invalid) {
+      if (value != nullptr) {
+        fprintf(stderr, "jdis_bench: Invalid value '%s' for %s.\n", value,
+            option);
+      }
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//  now : renvoie la valeur en secondes de l'horloge monotone.
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+//  rate : renvoie le débit de quantity unités en seconds secondes, ou 0 si
+//    seconds est nul.
+static double rate(double quantity, double seconds) {
+  return seconds > 0.0 ? quantity / seconds : 0.0;
+}
+
+//  print_result : écrit sur la sortie standard la ligne de résultats de la
+//    phase phase.
+static void print_result(const char *phase, size_t files, size_t words,
+    size_t bytes, size_t pairs, double seconds) {
+  printf("%s\t%zu\t%zu\t%zu\t%zu\t%.6f\t%.0f\t%.3f\t%.0f\n", phase, files,
+      words, bytes, pairs, seconds, rate((double) words, seconds),
+      rate((double) bytes, seconds) * 1e-6, rate((double) pairs, seconds));
+}
+
+//  time_graph_output : chronomètre handle_graph_output pour les num_files
+//    ensembles file_sets de noms filenames, internés dans lx, sa sortie étant
+//    redirigée vers le fichier BENCH_GRAPH_NAME du répertoire directory.
+//    Affecte à *seconds la durée et à *bytes la taille de la sortie. Renvoie
+//    0 en cas de succès, -1 en cas d'échec.
+static int time_graph_output(wordset **file_sets, size_t num_files,
+    char **filenames, const lexicon *lx, size_t num_jobs,
+    const char *directory, double *seconds, size_t *bytes) {
+  size_t length = strlen(directory) + sizeof "/" BENCH_GRAPH_NAME;
+  char *path = malloc(length);
+  if (path == nullptr) {
+    return -1;
+  }
+  snprintf(path, length, "%s/%s", directory, BENCH_GRAPH_NAME);
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  int saved = -1;
+  int r = -1;
+  if (fd == -1) {
+    goto cleanup;
+  }
+  fflush(stdout);
+  saved = dup(STDOUT_FILENO);
+  if (saved == -1 || dup2(fd, STDOUT_FILENO) == -1) {
+    goto cleanup;
+  }
+  double start = now();
+  handle_graph_output(file_sets, num_files, filenames, lx, 0, num_jobs);
+  fflush(stdout);
+  *seconds = now() - start;
+  dup2(saved, STDOUT_FILENO);
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    *bytes = (size_t) st.st_size;
+    r = 0;
+  }
+cleanup:
+  if (saved != -1) {
+    close(saved);
+  }
+  if (fd != -1) {
+    close(fd);
+    unlink(path);
+  }
+  free(path);
+  return r;
+}
+
+int main(int argc, char *argv[]) {
+  setlocale(LC_ALL, "");
+  bench_options options = {
+    .corpus = {
+      .file_words = 5000,
+      .vocabulary = 20000,
+      .zipf = 1.0,
+      .word_length = 7,
+      .punctuation = 0.05,
+      .seed = 1,
+    },
+    .num_files = 100,
+    .num_jobs = 1,
+    .punctuation_as_space = false,
+    .directory = nullptr,
+  };
+  int p = parse_options(argc, argv, &options);
+  if (p != 0) {
+    if (p > 0) {
+      print_bench_help();
+      return EXIT_SUCCESS;
+    }
+    fprintf(stderr, "Try 'jdis_bench --help' for more information.\n");
+    return EXIT_FAILURE;
+  }
+  int status = EXIT_FAILURE;
+  size_t n = options.num_files;
+  char template[] = "/tmp/jdis_bench.XXXXXX";
+  const char *directory = options.directory;
+  corpusgen *cg = corpusgen_create(&options.corpus);
+  char **names = calloc(n, sizeof *names);
+  wordset **sets = calloc(n, sizeof *sets);
+  lexicon *lx = lexicon_empty();
+  size_t num_written = 0;
+  if (cg == nullptr || names == nullptr || sets == nullptr || lx == nullptr) {
+    fprintf(stderr, "jdis_bench: Failed to allocate the corpus.\n");
+    goto cleanup;
+  }
+  if (directory == nullptr) {
+    directory = mkdtemp(template);
+    if (directory == nullptr) {
+      fprintf(stderr, "jdis_bench: Cannot create a temporary directory.\n");
+      goto cleanup;
+    }
+  }
+  size_t total_bytes = 0;
+  size_t length = strlen(directory) + sizeof "/f.txt" + 3 * sizeof(size_t);
+  for (size_t i = 0; i < n; ++i) {
+    names[i] = malloc(length);
+    if (names[i] == nullptr) {
+      fprintf(stderr, "jdis_bench: Failed to allocate the corpus.\n");
+      goto cleanup;
+    }
+    snprintf(names[i], length, BENCH_NAME_FORMAT, directory, i);
+    size_t bytes;
+    if (corpusgen_write(cg, i, names[i], &bytes) != 0) {
+      fprintf(stderr, "jdis_bench: Cannot write '%s'.\n", names[i]);
+      unlink(names[i]);
+      goto cleanup;
+    }
+    num_written += 1;
+    total_bytes += bytes;
+  }
+  printf("# files=%zu file_words=%zu vocabulary=%zu zipf=%g word_length=%zu"
+      " punctuation_density=%g seed=%" PRIu64 " jobs=%zu"
+      " punctuation_like_space=%d\n", n, options.corpus.file_words,
+      options.corpus.vocabulary, options.corpus.zipf,
+      options.corpus.word_length, options.corpus.punctuation,
+      options.corpus.seed, options.num_jobs, options.punctuation_as_space);
+  printf("phase\tfiles\twords\tbytes\tpairs\tseconds\twords_per_s\tmb_per_s"
+      "\tpairs_per_s\n");
+  double start = now();
+  for (size_t i = 0; i < n; ++i) {
+    sets[i] = get_words(names[i], lx, nullptr, 0,
+        options.punctuation_as_space);
+    if (sets[i] == nullptr) {
+      fprintf(stderr, "jdis_bench: Cannot read '%s'.\n", names[i]);
+      goto cleanup;
+    }
+  }
+  double seconds = now() - start;
+  print_result("get_words", n, n * options.corpus.file_words, total_bytes, 0,
+      seconds);
+  size_t merged = 0;
+  for (size_t i = 0; i < n; ++i) {
+    merged += (n - 1) * wordset_count(sets[i]);
+  }
+  start = now();
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = i + 1; k < n; ++k) {
+      jaccard_distance(sets[i], sets[k]);
+    }
+  }
+  seconds = now() - start;
+  print_result("jaccard_distance", n, merged, 0, n * (n - 1) / 2, seconds);
+  size_t graph_bytes = 0;
+  if (time_graph_output(sets, n, names, lx, options.num_jobs, directory,
+      &seconds, &graph_bytes) != 0) {
+    fprintf(stderr, "jdis_bench: Cannot redirect the graph output.\n");
+    goto cleanup;
+  }
+  print_result("handle_graph_output", n, lexicon_count(lx), graph_bytes, 0,
+      seconds);
+  status = EXIT_SUCCESS;
+cleanup:
+  for (size_t i = 0; i < num_written && options.directory == nullptr; ++i) {
+    unlink(names[i]);
+  }
+  if (directory != nullptr && options.directory == nullptr) {
+    rmdir(directory);
+  }
+  jdis_dispose_wordset_array(sets, n);
+  for (size_t i = 0; names != nullptr && i < n; ++i) {
+    free(names[i]);
+  }
+  free(names);
+  lexicon_dispose(&lx);
+  corpusgen_dispose(&cg);
+  return status;
+}
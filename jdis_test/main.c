@@ -1,21 +1,173 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <locale.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <errno.h>
+#include "arena.h"
+#include "corpusindex.h"
 #include "hashtable.h"
-#include "holdall.h"
-#include "holdall_ip.h"
+#include "lexicon.h"
+#include "minhash.h"
+#include "threadpool.h"
+#include "wordcache.h"
+#include "wordset.h"
 #include "jdis.h"
 
-#define MAX_FILES_SUPPORTED 64
+//  DEFAULT_LSH_MINHASH_SIZE : taille des signatures MinHash lorsque l'option
+//    --lsh est donnée sans l'option --minhash.
+#define DEFAULT_LSH_MINHASH_SIZE 128
+
+//  parse_engine : affecte à *engine le moteur de nom name ('auto', 'merge',
+//    'bitset', 'index' ou 'join'). Renvoie une valeur non nulle si name ne
+//    désigne aucun moteur. Renvoie sinon zéro.
+static int parse_engine(const char *name, jdis_engine *engine) {
+  if (strcmp(name, "auto") == 0) {
+    *engine = JDIS_ENGINE_AUTO;
+  } else if (strcmp(name, "merge") == 0) {
+    *engine = JDIS_ENGINE_MERGE;
+  } else if (strcmp(name, "bitset") == 0) {
+    *engine = JDIS_ENGINE_BITSET;
+  } else if (strcmp(name, "index") == 0) {
+    *engine = JDIS_ENGINE_INDEX;
+  } else if (strcmp(name, "join") == 0) {
+    *engine = JDIS_ENGINE_JOIN;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+//  parse_size : affecte à *value l'entier naturel dont l'écriture décimale est
+//    la chaîne s s'il est compris entre min et max. Renvoie une valeur non
+//    nulle si s n'est pas l'écriture d'un tel entier. Renvoie sinon zéro.
+static int parse_size(const char *s, size_t min, size_t max, size_t *value) {
+  char *endptr;
+  errno = 0;
+  unsigned long long val = strtoull(s, &endptr, 10);
+  if (endptr == s || *endptr != '\0' || errno == ERANGE || s[0] == '-'
+      || val < min || val > max) {
+    return -1;
+  }
+  *value = (size_t) val;
+  return 0;
+}
+
+//  parse_distance : affecte à *value le nombre dont l'écriture décimale est la
+//    chaîne s s'il est compris entre 0 et 1. Renvoie une valeur non nulle si s
+//    n'est pas l'écriture d'un tel nombre. Renvoie sinon zéro.
+static int parse_distance(const char *s, float *value) {
+  char *endptr;
+  errno = 0;
+  float val = strtof(s, &endptr);
+  if (endptr == s || *endptr != '\0' || errno == ERANGE || !(val >= 0.0f)
+      || val > 1.0f) {
+    return -1;
+  }
+  *value = val;
+  return 0;
+}
+
+//  file_list : liste des noms des fichiers à traiter.
+//    Membres :
+//      names : tableau dynamique des noms, dans l'ordre.
+//      count : nombre de noms.
+//      capacity : capacité du tableau names.
+//      strings : arène dans laquelle sont rangés les noms lus dans une liste
+//                de fichiers, ou nullptr.
+typedef struct {
+  char **names;
+  size_t count;
+  size_t capacity;
+  arena *strings;
+} file_list;
+
+//  file_list_append : ajoute le nom name à la fin de la liste fl. Renvoie 0 en
+//    cas de succès, -1 en cas de dépassement de capacité.
+static int file_list_append(file_list *fl, char *name) {
+  if (fl->count == fl->capacity) {
+    size_t c = fl->capacity == 0 ? 64 : 2 * fl->capacity;
+    char **a = realloc(fl->names, c * sizeof *a);
+    if (a == nullptr) {
+      return -1;
+    }
+    fl->names = a;
+    fl->capacity = c;
+  }
+  fl->names[fl->count] = name;
+  fl->count += 1;
+  return 0;
+}
+
+//  file_list_read : ajoute à la fin de la liste fl les noms lus dans le
+//    fichier filename, ou sur l'entrée standard si filename vaut "-", à
+//    raison d'un nom par ligne, les lignes vides étant ignorées. Renvoie 0 en
+//    cas de succès, -1 si le fichier ne peut être lu ou en cas de dépassement
+//    de capacité.
+static int file_list_read(file_list *fl, const char *filename) {
+  if (fl->strings == nullptr) {
+    fl->strings = arena_empty();
+    if (fl->strings == nullptr) {
+      return -1;
+    }
+  }
+  FILE *f = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+  if (f == nullptr) {
+    return -1;
+  }
+  char *line = nullptr;
+  size_t n = 0;
+  ssize_t length;
+  int r = 0;
+  while (r == 0 && (length = getline(&line, &n, f)) != -1) {
+    if (length > 0 && line[length - 1] == '\n') {
+      length -= 1;
+    }
+    if (length == 0) {
+      continue;
+    }
+    char *name = arena_strndup(fl->strings, line, (size_t) length);
+    if (name == nullptr || file_list_append(fl, name) != 0) {
+      r = -1;
+    }
+  }
+  if (ferror(f)) {
+    r = -1;
+  }
+  free(line);
+  if (f != stdin) {
+    fclose(f);
+  }
+  return r;
+}
+
+//  file_list_dispose : libère les ressources allouées à la gestion de la
+//    liste fl.
+static void file_list_dispose(file_list *fl) {
+  free(fl->names);
+  fl->names = nullptr;
+  fl->count = 0;
+  fl->capacity = 0;
+  arena_dispose(&fl->strings);
+}
 
 int main(int argc, char *argv[]) {
   setlocale(LC_ALL, "");
   bool graph_mode = false;
   int initial_letters_limit = 0;
   bool punctuation_as_space = false;
+  jdis_engine engine = JDIS_ENGINE_AUTO;
+  size_t minhash_size = 0;
+  size_t lsh_bands = 0;
+  size_t num_jobs = 1;
+  size_t top_k = 0;
+  const char *cache_dir = nullptr;
+  const char *index_file = nullptr;
+  const char *files_from = nullptr;
+  float max_distance = 1.0f;
   int opt_args_count = 0;
   for (int i = 1; i < argc; ++i) {
     if (strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--graph") == 0) {
@@ -63,6 +215,192 @@ int main(int argc, char *argv[]) {
         "--punctuation-like-space") == 0) {
       punctuation_as_space = true;
       opt_args_count++;
+    } else if (strcmp(argv[i], "-e") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_engine(argv[i + 1], &engine) != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for -e: '%s'. Must be 'auto', 'merge', 'bitset', 'index' or 'join'.\n",
+              argv[i + 1]);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option -e requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--engine=", strlen("--engine=")) == 0) {
+      const char *value_str = argv[i] + strlen("--engine=");
+      if (parse_engine(value_str, &engine) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --engine: '%s'. Must be 'auto', 'merge', 'bitset', 'index' or 'join'.\n",
+            value_str);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--minhash") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_size(argv[i + 1], 1, MINHASH_MAX_SIZE, &minhash_size) != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for --minhash: '%s'. Must be an integer between 1 and %d.\n",
+              argv[i + 1], MINHASH_MAX_SIZE);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --minhash requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--minhash=", strlen("--minhash=")) == 0) {
+      const char *value_str = argv[i] + strlen("--minhash=");
+      if (parse_size(value_str, 1, MINHASH_MAX_SIZE, &minhash_size) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --minhash: '%s'. Must be an integer between 1 and %d.\n",
+            value_str, MINHASH_MAX_SIZE);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--lsh") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_size(argv[i + 1], 1, MINHASH_MAX_SIZE, &lsh_bands) != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for --lsh: '%s'. Must be an integer between 1 and %d.\n",
+              argv[i + 1], MINHASH_MAX_SIZE);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --lsh requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--lsh=", strlen("--lsh=")) == 0) {
+      const char *value_str = argv[i] + strlen("--lsh=");
+      if (parse_size(value_str, 1, MINHASH_MAX_SIZE, &lsh_bands) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --lsh: '%s'. Must be an integer between 1 and %d.\n",
+            value_str, MINHASH_MAX_SIZE);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
+    } else if (strcmp(argv[i], "-j") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_size(argv[i + 1], 1, THREADPOOL_MAX_THREADS, &num_jobs)
+            != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for -j: '%s'. Must be an integer between 1 and %d.\n",
+              argv[i + 1], THREADPOOL_MAX_THREADS);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option -j requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--jobs=", strlen("--jobs=")) == 0) {
+      const char *value_str = argv[i] + strlen("--jobs=");
+      if (parse_size(value_str, 1, THREADPOOL_MAX_THREADS, &num_jobs) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --jobs: '%s'. Must be an integer between 1 and %d.\n",
+            value_str, THREADPOOL_MAX_THREADS);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--top") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_size(argv[i + 1], 1, SIZE_MAX, &top_k) != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for --top: '%s'. Must be a positive integer.\n",
+              argv[i + 1]);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --top requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--top=", strlen("--top=")) == 0) {
+      const char *value_str = argv[i] + strlen("--top=");
+      if (parse_size(value_str, 1, SIZE_MAX, &top_k) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --top: '%s'. Must be a positive integer.\n",
+            value_str);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--cache") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        cache_dir = argv[i + 1];
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --cache requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--cache=", strlen("--cache=")) == 0) {
+      cache_dir = argv[i] + strlen("--cache=");
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--files-from") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        files_from = argv[i + 1];
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --files-from requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--files-from=", strlen("--files-from="))
+        == 0) {
+      files_from = argv[i] + strlen("--files-from=");
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--index") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        index_file = argv[i + 1];
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --index requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--index=", strlen("--index=")) == 0) {
+      index_file = argv[i] + strlen("--index=");
+      opt_args_count++;
+    } else if (strcmp(argv[i], "--max-distance") == 0) {
+      opt_args_count++;
+      if (i + 1 < argc) {
+        if (parse_distance(argv[i + 1], &max_distance) != 0) {
+          fprintf(stderr,
+              "jdis: Invalid value for --max-distance: '%s'. Must be a number between 0 and 1.\n",
+              argv[i + 1]);
+          return EXIT_FAILURE;
+        }
+        i++;
+        opt_args_count++;
+      } else {
+        fprintf(stderr, "jdis: Option --max-distance requires a value.\n");
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--max-distance=", strlen("--max-distance="))
+        == 0) {
+      const char *value_str = argv[i] + strlen("--max-distance=");
+      if (parse_distance(value_str, &max_distance) != 0) {
+        fprintf(stderr,
+            "jdis: Invalid value for --max-distance: '%s'. Must be a number between 0 and 1.\n",
+            value_str);
+        return EXIT_FAILURE;
+      }
+      opt_args_count++;
     } else {
       if (argv[i][0] == '-') {
         fprintf(stderr, "jdis: unrecognized option '%s'\n", argv[i]);
@@ -72,63 +410,188 @@ int main(int argc, char *argv[]) {
       break;
     }
   }
-  int first_file_idx = 1 + opt_args_count;
-  size_t num_actual_files = 0;
-  if (argc >= first_file_idx) {
-    num_actual_files = (size_t) (argc - first_file_idx);
+  if (lsh_bands > 0 && minhash_size == 0) {
+    minhash_size = DEFAULT_LSH_MINHASH_SIZE;
   }
-  if (num_actual_files > MAX_FILES_SUPPORTED) {
-    fprintf(stderr, "jdis: Too many files. At most %d files are supported.\n",
-        MAX_FILES_SUPPORTED);
+  if (lsh_bands > minhash_size) {
+    fprintf(stderr,
+        "jdis: The number of LSH bands (%zu) exceeds the MinHash signature size (%zu).\n",
+        lsh_bands, minhash_size);
     fprintf(stderr, "Try 'jdis --help' for more information.\n");
     return EXIT_FAILURE;
   }
+  if (index_file != nullptr && (graph_mode || minhash_size > 0)) {
+    fprintf(stderr,
+        "jdis: Option --index cannot be combined with -g, --minhash or --lsh.\n");
+    fprintf(stderr, "Try 'jdis --help' for more information.\n");
+    return EXIT_FAILURE;
+  }
+  if (top_k > 0
+      && (graph_mode || minhash_size > 0 || index_file != nullptr)) {
+    fprintf(stderr,
+        "jdis: Option --top cannot be combined with -g, --minhash, --lsh or --index.\n");
+    fprintf(stderr, "Try 'jdis --help' for more information.\n");
+    return EXIT_FAILURE;
+  }
+  int first_file_idx = 1 + opt_args_count;
+  file_list files = {
+    .names = nullptr, .count = 0, .capacity = 0, .strings = nullptr
+  };
+  for (int i = first_file_idx; i < argc; ++i) {
+    if (file_list_append(&files, argv[i]) != 0) {
+      fprintf(stderr, "Failed to allocate memory for file list\n");
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
+    }
+  }
+  if (files_from != nullptr && file_list_read(&files, files_from) != 0) {
+    fprintf(stderr, "jdis: Cannot read the list of files '%s'.\n",
+        files_from);
+    file_list_dispose(&files);
+    return EXIT_FAILURE;
+  }
+  size_t num_actual_files = files.count;
   if (num_actual_files < 2 && graph_mode == false) {
     fprintf(stderr,
         "jdis: At least two files are required for Jaccard distance.\n");
     fprintf(stderr, "Try 'jdis --help' for more information.\n");
+    file_list_dispose(&files);
     return EXIT_FAILURE;
   }
   if (num_actual_files < 2 && graph_mode == true) {
     fprintf(stderr, "jdis: At least one file is required for graph mode.\n");
     fprintf(stderr, "Try 'jdis --help' for more information.\n");
+    file_list_dispose(&files);
     return EXIT_FAILURE;
   }
   if (num_actual_files == 0 && graph_mode == false) {
     fprintf(stderr, "jdis: Missing operands (filenames).\n");
     fprintf(stderr, "Try 'jdis --help' for more information.\n");
+    file_list_dispose(&files);
+    return EXIT_FAILURE;
+  }
+  char **actual_filenames = files.names;
+  lexicon *lx = lexicon_empty();
+  if (lx == nullptr) {
+    fprintf(stderr, "Failed to allocate memory for lexicon\n");
+    file_list_dispose(&files);
     return EXIT_FAILURE;
   }
-  holdall **ht_tab = malloc(sizeof(*ht_tab) * num_actual_files);
+  wordset **ht_tab = malloc(sizeof(*ht_tab) * num_actual_files);
   if (ht_tab == nullptr) {
     fprintf(stderr, "Failed to allocate memory for hashtable array\n");
+    lexicon_dispose(&lx);
+    file_list_dispose(&files);
     return EXIT_FAILURE;
   }
   for (size_t i = 0; i < num_actual_files; ++i) {
     ht_tab[i] = nullptr;
   }
-  char **actual_filenames = &argv[first_file_idx];
-  for (size_t i = 0; i < num_actual_files; ++i) {
-    ht_tab[i] = get_words(actual_filenames[i], initial_letters_limit,
+  minhash **signatures = nullptr;
+  if (minhash_size > 0 && graph_mode == false) {
+    signatures = calloc(num_actual_files, sizeof(*signatures));
+    for (size_t i = 0; signatures != nullptr && i < num_actual_files; ++i) {
+      signatures[i] = minhash_empty(minhash_size);
+      if (signatures[i] == nullptr) {
+        jdis_dispose_minhash_array(signatures, num_actual_files);
+        signatures = nullptr;
+      }
+    }
+    if (signatures == nullptr) {
+      fprintf(stderr, "Failed to allocate memory for MinHash signatures\n");
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
+    }
+  }
+  wordcache *cache = nullptr;
+  if (cache_dir != nullptr) {
+    cache = wordcache_open(cache_dir);
+    if (cache == nullptr) {
+      fprintf(stderr, "jdis: Cannot use '%s' as a cache directory.\n",
+          cache_dir);
+      jdis_dispose_minhash_array(signatures, num_actual_files);
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
+    }
+  }
+  corpusindex *index = nullptr;
+  jdis_file_record *records = nullptr;
+  if (index_file != nullptr) {
+    index = corpusindex_load(index_file, initial_letters_limit,
         punctuation_as_space);
-    if (ht_tab[i] == nullptr) {
-      fprintf(stderr, "An Error occurred while processing file: %s\n",
-          actual_filenames[i]);
-      jdis_dispose_holdall_array(ht_tab, num_actual_files);
+    records = malloc(sizeof(*records) * num_actual_files);
+    if (records == nullptr) {
+      fprintf(stderr, "Failed to allocate memory for index records\n");
+      corpusindex_dispose(&index);
+      wordcache_close(&cache);
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
       return EXIT_FAILURE;
     }
   }
+  size_t num_read = get_corpus_words(actual_filenames, num_actual_files, lx,
+      signatures, initial_letters_limit, punctuation_as_space, num_jobs, cache,
+      index, records,
+      signatures != nullptr && lsh_bands == 0 ? nullptr : ht_tab);
+  wordcache_close(&cache);
+  if (num_read < num_actual_files) {
+    fprintf(stderr, "An Error occurred while processing file: %s\n",
+        actual_filenames[num_read]);
+    jdis_dispose_record_array(records, num_actual_files);
+    corpusindex_dispose(&index);
+    jdis_dispose_minhash_array(signatures, num_actual_files);
+    jdis_dispose_wordset_array(ht_tab, num_actual_files);
+    lexicon_dispose(&lx);
+    file_list_dispose(&files);
+    return EXIT_FAILURE;
+  }
   if (graph_mode == true) {
-    handle_graph_output(ht_tab, num_actual_files, actual_filenames,
-        initial_letters_limit);
-  } else {
-    for (size_t j = 0; j < num_actual_files; ++j) {
-      for (size_t k = j + 1; k < num_actual_files; ++k) {
-        float d = jaccard_distance(ht_tab[j], ht_tab[k]);
-        printf("%.4f\t%s\t%s\n", d, actual_filenames[j], actual_filenames[k]);
-      }
+    handle_graph_output(ht_tab, num_actual_files, actual_filenames, lx,
+        initial_letters_limit, num_jobs);
+  } else if (lsh_bands > 0) {
+    if (handle_lsh_output(ht_tab, signatures, num_actual_files,
+        actual_filenames, lsh_bands, max_distance) != 0) {
+      jdis_dispose_minhash_array(signatures, num_actual_files);
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
     }
+  } else if (top_k > 0) {
+    if (handle_top_output(ht_tab, num_actual_files, actual_filenames, lx,
+        engine, top_k, max_distance, num_jobs) != 0) {
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
+    }
+  } else if (signatures != nullptr) {
+    handle_minhash_output(signatures, num_actual_files, actual_filenames,
+        max_distance);
+  } else if (index_file != nullptr) {
+    int r = handle_indexed_pairs_output(ht_tab, num_actual_files,
+        actual_filenames, lx, index, records, index_file,
+        initial_letters_limit, punctuation_as_space, max_distance);
+    jdis_dispose_record_array(records, num_actual_files);
+    corpusindex_dispose(&index);
+    if (r != 0) {
+      jdis_dispose_wordset_array(ht_tab, num_actual_files);
+      lexicon_dispose(&lx);
+      file_list_dispose(&files);
+      return EXIT_FAILURE;
+    }
+  } else {
+    handle_pairs_output(ht_tab, num_actual_files, actual_filenames, lx,
+        engine, max_distance, num_jobs);
   }
-  jdis_dispose_holdall_array(ht_tab, num_actual_files);
+  jdis_dispose_minhash_array(signatures, num_actual_files);
+  jdis_dispose_wordset_array(ht_tab, num_actual_files);
+  lexicon_dispose(&lx);
+  file_list_dispose(&files);
   return EXIT_SUCCESS;
 }
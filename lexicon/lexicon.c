@@ -0,0 +1,110 @@
+//  lexicon.c : partie implantation du module lexicon.
+
+#include <stdint.h>
+#include <string.h>
+#include "lexicon.h"
+#include "arena.h"
+#include "hashtable.h"
+
+//  struct lexicon, lexicon : la table de hachage table associe chaque copie de
+//    mot à son identifiant augmenté de un (une référence de valeur ne pouvant
+//    être nulle). Les copies sont rangées dans l'arène strings. Le tableau
+//    words, de capacité capacity, les repère dans l'ordre des identifiants ;
+//    count est le nombre de mots.
+struct lexicon {
+  hashtable *table;
+  arena *strings;
+  char **words;
+  size_t capacity;
+  size_t count;
+};
+
+#define LEXICON__INITIAL_CAPACITY 1024
+
+//  lexicon__compar : fonction de comparaison des clés de la table. L'égalité
+//    des mots est l'égalité octet par octet.
+static int lexicon__compar(const void *a, const void *b) {
+  return strcmp((const char *) a, (const char *) b);
+}
+
+//  lexicon__hash : fonction de pré-hachage des clés de la table (algorithme
+//    djb2).
+static size_t lexicon__hash(const void *key) {
+  const unsigned char *s = (const unsigned char *) key;
+  size_t h = 5381;
+  for (; *s != '\0'; ++s) {
+    h = ((h << 5) + h) + *s;
+  }
+  return h;
+}
+
+lexicon *lexicon_empty(void) {
+  lexicon *lx = malloc(sizeof *lx);
+  if (lx == nullptr) {
+    return nullptr;
+  }
+  lx->table = hashtable_empty(lexicon__compar, lexicon__hash, 0.75);
+  lx->strings = arena_empty();
+  lx->words = malloc(LEXICON__INITIAL_CAPACITY * sizeof *lx->words);
+  if (lx->table == nullptr || lx->strings == nullptr || lx->words == nullptr) {
+    hashtable_dispose(&lx->table);
+    arena_dispose(&lx->strings);
+    free(lx->words);
+    free(lx);
+    return nullptr;
+  }
+  lx->capacity = LEXICON__INITIAL_CAPACITY;
+  lx->count = 0;
+  return lx;
+}
+
+void lexicon_dispose(lexicon **lxptr) {
+  if (*lxptr == nullptr) {
+    return;
+  }
+  arena_dispose(&(*lxptr)->strings);
+  free((*lxptr)->words);
+  hashtable_dispose(&(*lxptr)->table);
+  free(*lxptr);
+  *lxptr = nullptr;
+}
+
+uint32_t lexicon_intern(lexicon *lx, const char *word) {
+  const void *v = hashtable_search(lx->table, word);
+  if (v != nullptr) {
+    return (uint32_t) ((uintptr_t) v - 1);
+  }
+  if (lx->count >= LEXICON_NOID) {
+    return LEXICON_NOID;
+  }
+  if (lx->count == lx->capacity) {
+    if (lx->capacity > SIZE_MAX / 2 / sizeof *lx->words) {
+      return LEXICON_NOID;
+    }
+    char **a = realloc(lx->words, 2 * lx->capacity * sizeof *lx->words);
+    if (a == nullptr) {
+      return LEXICON_NOID;
+    }
+    lx->words = a;
+    lx->capacity *= 2;
+  }
+  char *w = arena_strdup(lx->strings, word);
+  if (w == nullptr) {
+    return LEXICON_NOID;
+  }
+  uint32_t id = (uint32_t) lx->count;
+  if (hashtable_add(lx->table, w, (void *) ((uintptr_t) id + 1)) == nullptr) {
+    return LEXICON_NOID;
+  }
+  lx->words[id] = w;
+  lx->count += 1;
+  return id;
+}
+
+const char *lexicon_word(const lexicon *lx, uint32_t id) {
+  return lx->words[id];
+}
+
+size_t lexicon_count(const lexicon *lx) {
+  return lx->count;
+}
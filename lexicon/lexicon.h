@@ -0,0 +1,52 @@
+//  lexicon.h : partie interface d'un module de dictionnaire d'internement des
+//    mots d'un corpus.
+//  Fonctionnement général :
+//  - chaque mot distinct rencontré dans l'ensemble des fichiers reçoit, lors
+//    de sa première insertion, un identifiant entier dense de 32 bits : le
+//    premier mot interné reçoit 0, le suivant 1, et ainsi de suite ;
+//  - le dictionnaire conserve une unique copie de chaque mot, partagée par
+//    tous les fichiers qui le contiennent ;
+//  - une fois l'ingestion terminée, les comparaisons entre ensembles de mots
+//    portent sur les identifiants et non plus sur les chaînes.
+
+#ifndef LEXICON__H
+#define LEXICON__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  LEXICON_NOID : valeur d'identifiant qui ne désigne aucun mot. Elle est
+//    renvoyée par les fonctions du module en cas d'échec.
+#define LEXICON_NOID UINT32_MAX
+
+//  struct lexicon, lexicon : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour gérer un dictionnaire d'internement.
+typedef struct lexicon lexicon;
+
+//  lexicon_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouveau dictionnaire initialement vide. Renvoie un pointeur nul en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé au dictionnaire.
+extern lexicon *lexicon_empty(void);
+
+//  lexicon_dispose : sans effet si *lxptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion du dictionnaire associé à *lxptr, y
+//    compris les copies des mots, puis affecte un pointeur nul à *lxptr.
+extern void lexicon_dispose(lexicon **lxptr);
+
+//  lexicon_intern : recherche le mot word dans le dictionnaire associé à lx.
+//    Si la recherche est positive, renvoie son identifiant. Tente sinon d'en
+//    ajouter une copie au dictionnaire et renvoie le nouvel identifiant ;
+//    renvoie LEXICON_NOID en cas de dépassement de capacité.
+extern uint32_t lexicon_intern(lexicon *lx, const char *word);
+
+//  lexicon_word : renvoie la copie du mot d'identifiant id conservée par le
+//    dictionnaire associé à lx. Le comportement est indéterminé si id n'est
+//    pas strictement inférieur à lexicon_count(lx).
+extern const char *lexicon_word(const lexicon *lx, uint32_t id);
+
+//  lexicon_count : renvoie le nombre de mots distincts du dictionnaire associé
+//    à lx.
+extern size_t lexicon_count(const lexicon *lx);
+
+#endif
@@ -0,0 +1,169 @@
+//  lsh.c : partie implantation du module lsh.
+
+#include <stdlib.h>
+#include "lsh.h"
+
+//  lsh__bucket : entrée d'un regroupement par bande. key est la valeur de
+//    hachage de la bande de la signature du fichier d'indice index.
+typedef struct {
+  uint64_t key;
+  uint32_t index;
+} lsh__bucket;
+
+//  lsh__compar_buckets : fonction de comparaison pour qsort des entrées
+//    pointées par a et b, selon leur valeur de hachage puis leur indice.
+static int lsh__compar_buckets(const void *a, const void *b) {
+  const lsh__bucket *x = (const lsh__bucket *) a;
+  const lsh__bucket *y = (const lsh__bucket *) b;
+  if (x->key != y->key) {
+    return x->key < y->key ? -1 : 1;
+  }
+  return (x->index > y->index) - (x->index < y->index);
+}
+
+//  lsh__compar_pairs : fonction de comparaison pour qsort des couples pointés
+//    par a et b, selon l'ordre lexicographique.
+static int lsh__compar_pairs(const void *a, const void *b) {
+  const lsh_pair *x = (const lsh_pair *) a;
+  const lsh_pair *y = (const lsh_pair *) b;
+  if (x->first != y->first) {
+    return x->first < y->first ? -1 : 1;
+  }
+  return (x->second > y->second) - (x->second < y->second);
+}
+
+//  lsh__band_hash : renvoie la valeur de hachage (algorithme FNV-1a sur les
+//    valeurs de 32 bits) des r valeurs du tableau values, pour la bande
+//    d'indice band.
+static uint64_t lsh__band_hash(const uint32_t *values, size_t r, size_t band) {
+  uint64_t h = UINT64_C(0xCBF29CE484222325) ^ band;
+  for (size_t i = 0; i < r; ++i) {
+    h ^= values[i];
+    h *= UINT64_C(0x100000001B3);
+  }
+  return h;
+}
+
+//  lsh__put : tente d'ajouter le couple p au tableau dynamique *pairsptr de
+//    longueur *nptr et de capacité *capptr. Renvoie une valeur non nulle en
+//    cas de dépassement de capacité. Renvoie sinon zéro.
+static int lsh__put(lsh_pair **pairsptr, size_t *nptr, size_t *capptr,
+    lsh_pair p) {
+  if (*nptr == *capptr) {
+    size_t c = *capptr == 0 ? 1024 : 2 * *capptr;
+    if (c > SIZE_MAX / sizeof **pairsptr) {
+      return -1;
+    }
+    lsh_pair *a = realloc(*pairsptr, c * sizeof **pairsptr);
+    if (a == nullptr) {
+      return -1;
+    }
+    *pairsptr = a;
+    *capptr = c;
+  }
+  (*pairsptr)[*nptr] = p;
+  *nptr += 1;
+  return 0;
+}
+
+//  lsh__sort_unique : trie les n couples du tableau pairs dans l'ordre
+//    lexicographique et en retire les doublons. Renvoie le nombre de couples
+//    restants.
+static size_t lsh__sort_unique(lsh_pair *pairs, size_t n) {
+  if (n > 0) {
+    qsort(pairs, n, sizeof *pairs, lsh__compar_pairs);
+  }
+  size_t m = 0;
+  for (size_t k = 0; k < n; ++k) {
+    if (m == 0 || lsh__compar_pairs(&pairs[m - 1], &pairs[k]) != 0) {
+      pairs[m++] = pairs[k];
+    }
+  }
+  return m;
+}
+
+//  lsh__merge : tente de fusionner les u premiers couples du tableau
+//    dynamique *pairsptr, de capacité *capptr, avec les v suivants, les deux
+//    suites étant triées et sans doublon. Affecte à *nptr le nombre de couples
+//    de la fusion, sans doublon. Renvoie une valeur non nulle en cas de
+//    dépassement de capacité. Renvoie sinon zéro.
+static int lsh__merge(lsh_pair **pairsptr, size_t *nptr, size_t *capptr,
+    size_t u, size_t v) {
+  if (u == 0 || v == 0) {
+    *nptr = u + v;
+    return 0;
+  }
+  lsh_pair *a = *pairsptr;
+  lsh_pair *merged = malloc((u + v) * sizeof *merged);
+  if (merged == nullptr) {
+    return -1;
+  }
+  size_t x = 0;
+  size_t y = u;
+  size_t m = 0;
+  while (x < u || y < u + v) {
+    int c = x == u ? 1 : y == u + v ? -1
+        : lsh__compar_pairs(&a[x], &a[y]);
+    merged[m++] = c <= 0 ? a[x] : a[y];
+    x += c <= 0;
+    y += c >= 0;
+  }
+  free(a);
+  *pairsptr = merged;
+  *capptr = u + v;
+  *nptr = m;
+  return 0;
+}
+
+int lsh_candidate_pairs(minhash **signatures, size_t count,
+    size_t bands, lsh_pair **pairsptr, size_t *npairsptr) {
+  lsh_pair *pairs = nullptr;
+  size_t n = 0;
+  size_t capacity = 0;
+  lsh__bucket *buckets = malloc((count == 0 ? 1 : count) * sizeof *buckets);
+  if (buckets == nullptr) {
+    return -1;
+  }
+  size_t r = count == 0 ? 0 : minhash_size(signatures[0]) / bands;
+  for (size_t b = 0; b < bands && count > 0; ++b) {
+    size_t u = n;
+    for (size_t i = 0; i < count; ++i) {
+      buckets[i] = (lsh__bucket) {
+        lsh__band_hash(minhash_values(signatures[i]) + b * r, r, b),
+        (uint32_t) i
+      };
+    }
+    qsort(buckets, count, sizeof *buckets, lsh__compar_buckets);
+    for (size_t lo = 0; lo < count; ) {
+      size_t hi = lo + 1;
+      while (hi < count && buckets[hi].key == buckets[lo].key) {
+        ++hi;
+      }
+      for (size_t x = lo; x < hi; ++x) {
+        for (size_t y = x + 1; y < hi; ++y) {
+          if (lsh__put(&pairs, &n, &capacity, (lsh_pair) {
+              buckets[x].index, buckets[y].index
+            }) != 0) {
+            free(pairs);
+            free(buckets);
+            return -1;
+          }
+        }
+      }
+      lo = hi;
+    }
+    //  Les couples de la bande sont dédoublonnés puis fusionnés avec ceux des
+    //    bandes précédentes, de sorte que le tableau ne contienne jamais plus
+    //    que les couples distincts déjà retenus et ceux d'une bande.
+    size_t v = lsh__sort_unique(pairs + u, n - u);
+    if (lsh__merge(&pairs, &n, &capacity, u, v) != 0) {
+      free(pairs);
+      free(buckets);
+      return -1;
+    }
+  }
+  free(buckets);
+  *pairsptr = pairs;
+  *npairsptr = n;
+  return 0;
+}
@@ -0,0 +1,46 @@
+//  lsh.h : partie interface d'un module de hachage sensible à la localité
+//    (LSH) par bandes de signatures MinHash, pour la sélection des couples de
+//    fichiers candidats à la comparaison exacte.
+//  Fonctionnement général :
+//  - chaque signature de K valeurs est découpée en b bandes de r = K / b
+//    valeurs consécutives (les K - b r dernières valeurs sont ignorées) ;
+//  - deux fichiers forment un couple candidat si leurs signatures coïncident
+//    sur toutes les valeurs d'au moins une bande. Pour deux ensembles de
+//    similarité de Jaccard s, cela se produit avec la probabilité
+//    1 - (1 - s^r)^b, fonction en S dont le point d'inflexion est voisin de
+//    (1 / b)^(1 / r) ;
+//  - les fichiers de chaque bande sont regroupés par tri sur une valeur de
+//    hachage de la bande : deux fichiers dont les bandes diffèrent mais ont la
+//    même valeur de hachage forment un faux candidat, éliminé par la
+//    comparaison exacte ;
+//  - les couples de chaque bande sont dédoublonnés et fusionnés avec ceux des
+//    bandes précédentes au fil des bandes : la mémoire occupée par les
+//    couples est de l'ordre du nombre de couples distincts retenus augmenté
+//    de celui d'une bande, soit O(count²) pour count fichiers quel que soit
+//    le nombre de bandes, ce maximum étant atteint lorsque tous les fichiers
+//    tombent dans un même groupe (fichiers vides ou identiques par exemple).
+
+#ifndef LSH__H
+#define LSH__H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "minhash.h"
+
+//  lsh_pair : couple candidat de fichiers, repérés par leurs indices first et
+//    second, avec first < second.
+typedef struct {
+  uint32_t first;
+  uint32_t second;
+} lsh_pair;
+
+//  lsh_candidate_pairs : calcule les couples candidats des count signatures
+//    du tableau signatures, toutes de même taille K, découpées en bands
+//    bandes, 1 ≤ bands ≤ K. En cas de succès, affecte à *pairsptr l'adresse
+//    d'un tableau alloué dynamiquement des couples candidats, sans doublon et
+//    dans l'ordre lexicographique, et à *npairsptr leur nombre, puis renvoie
+//    zéro. Renvoie une valeur non nulle en cas de dépassement de capacité.
+extern int lsh_candidate_pairs(minhash **signatures, size_t count,
+    size_t bands, lsh_pair **pairsptr, size_t *npairsptr);
+
+#endif
@@ -0,0 +1,89 @@
+//  minhash.c : partie implantation du module minhash.
+
+#include <stdlib.h>
+#include "minhash.h"
+
+//  struct minhash, minhash : k est le nombre de valeurs de la signature,
+//    rangées dans le tableau values. Les valeurs d'un ensemble vide valent
+//    UINT32_MAX.
+struct minhash {
+  size_t k;
+  uint32_t values[];
+};
+
+//  MINHASH__GOLDEN : partie fractionnaire du nombre d'or sur 64 bits. Le
+//    germe de la fonction d'indice i est (i + 1) * MINHASH__GOLDEN.
+#define MINHASH__GOLDEN UINT64_C(0x9E3779B97F4A7C15)
+
+//  minhash__string_hash : renvoie la valeur de hachage sur 64 bits (algorithme
+//    FNV-1a) de la chaîne s.
+static uint64_t minhash__string_hash(const char *s) {
+  uint64_t h = UINT64_C(0xCBF29CE484222325);
+  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
+    h ^= *p;
+    h *= UINT64_C(0x100000001B3);
+  }
+  return h;
+}
+
+//  minhash__mix : renvoie l'image de x par la fonction de finalisation de
+//    MurmurHash3, bijective et à bonne diffusion.
+static uint64_t minhash__mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= UINT64_C(0xFF51AFD7ED558CCD);
+  x ^= x >> 33;
+  x *= UINT64_C(0xC4CEB9FE1A85EC53);
+  x ^= x >> 33;
+  return x;
+}
+
+minhash *minhash_empty(size_t k) {
+  if (k == 0 || k > MINHASH_MAX_SIZE) {
+    return nullptr;
+  }
+  minhash *mh = malloc(sizeof *mh + k * sizeof mh->values[0]);
+  if (mh == nullptr) {
+    return nullptr;
+  }
+  mh->k = k;
+  for (size_t i = 0; i < k; ++i) {
+    mh->values[i] = UINT32_MAX;
+  }
+  return mh;
+}
+
+void minhash_dispose(minhash **mhptr) {
+  if (*mhptr == nullptr) {
+    return;
+  }
+  free(*mhptr);
+  *mhptr = nullptr;
+}
+
+void minhash_add(minhash *mh, const char *word) {
+  uint64_t h = minhash__string_hash(word);
+  uint64_t seed = 0;
+  for (size_t i = 0; i < mh->k; ++i) {
+    seed += MINHASH__GOLDEN;
+    uint32_t v = (uint32_t) (minhash__mix(h ^ seed) >> 32);
+    if (v < mh->values[i]) {
+      mh->values[i] = v;
+    }
+  }
+}
+
+size_t minhash_size(const minhash *mh) {
+  return mh->k;
+}
+
+const uint32_t *minhash_values(const minhash *mh) {
+  return mh->values;
+}
+
+float minhash_distance(const minhash *mh1, const minhash *mh2) {
+  size_t matches = 0;
+  for (size_t i = 0; i < mh1->k; ++i) {
+    matches += (mh1->values[i] == mh2->values[i]);
+  }
+  return 1.0f - (float) matches / (float) mh1->k;
+}
@@ -0,0 +1,60 @@
+//  minhash.h : partie interface d'un module de signatures MinHash, pour
+//    l'estimation de la dissimilarité de Jaccard entre ensembles de mots.
+//  Fonctionnement général :
+//  - une signature de K valeurs est associée à un ensemble de mots. Sa valeur
+//    d'indice i est le minimum, sur les mots de l'ensemble, d'une fonction de
+//    hachage h_i propre à l'indice ;
+//  - pour deux ensembles A et B, la probabilité que leurs signatures aient la
+//    même valeur d'indice i est leur similarité de Jaccard |A∩B| / |A∪B| : la
+//    proportion d'indices où les signatures coïncident en est un estimateur
+//    sans biais, d'écart type sqrt(J (1 - J) / K) ≤ 1 / (2 sqrt(K)) ;
+//  - les valeurs ne dépendent que des mots, et non de l'ordre de leur ajout ni
+//    des identifiants que leur attribue un dictionnaire ;
+//  - une signature occupe 4 K octets, en un seul bloc, quel que soit le
+//    nombre de mots de l'ensemble.
+
+#ifndef MINHASH__H
+#define MINHASH__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  MINHASH_MAX_SIZE : nombre maximal de valeurs d'une signature.
+#define MINHASH_MAX_SIZE 65536
+
+//  struct minhash, minhash : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une signature.
+typedef struct minhash minhash;
+
+//  minhash_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    signature de k valeurs, 1 ≤ k ≤ MINHASH_MAX_SIZE, d'un ensemble
+//    initialement vide. Renvoie un pointeur nul si k n'est pas dans les bornes
+//    ou en cas de dépassement de capacité. Renvoie sinon un pointeur vers le
+//    contrôleur associé à la signature.
+extern minhash *minhash_empty(size_t k);
+
+//  minhash_dispose : sans effet si *mhptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de la signature associée à *mhptr
+//    puis affecte un pointeur nul à *mhptr.
+extern void minhash_dispose(minhash **mhptr);
+
+//  minhash_add : met à jour la signature associée à mh pour tenir compte de
+//    l'ajout du mot word à l'ensemble. Ajouter plusieurs fois le même mot est
+//    sans effet supplémentaire. Temps en O(K).
+extern void minhash_add(minhash *mh, const char *word);
+
+//  minhash_size : renvoie le nombre K de valeurs de la signature associée à
+//    mh.
+extern size_t minhash_size(const minhash *mh);
+
+//  minhash_values : renvoie l'adresse du tableau des minhash_size(mh) valeurs
+//    de la signature associée à mh.
+extern const uint32_t *minhash_values(const minhash *mh);
+
+//  minhash_distance : renvoie l'estimation de la dissimilarité de Jaccard des
+//    ensembles dont mh1 et mh2 sont les signatures, qui doivent être de même
+//    taille K : un moins la proportion des K indices où elles coïncident.
+//    Temps en O(K).
+extern float minhash_distance(const minhash *mh1, const minhash *mh2);
+
+#endif
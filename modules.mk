@@ -0,0 +1,79 @@
+# modules.mk : liste des modules de jdis, options de compilation et
+#   dépendances de leurs fichiers objets, partagées par les makefiles des
+#   répertoires jdis_test et jdis_bench, qui doivent l'inclure depuis l'un
+#   d'eux.
+
+# Les règles de ce fichier précédant celles du makefile qui l'inclut, la
+#   cible par défaut de ce dernier est fixée à all.
+.DEFAULT_GOAL = all
+
+jdis_dir = ../jdis/
+hashtable_dir = ../hashtable/
+lexicon_dir = ../lexicon/
+wordset_dir = ../wordset/
+bitmatrix_dir = ../bitmatrix/
+minhash_dir = ../minhash/
+lsh_dir = ../lsh/
+threadpool_dir = ../threadpool/
+tokenizer_dir = ../tokenizer/
+arena_dir = ../arena/
+slab_dir = ../slab/
+strsort_dir = ../strsort/
+outbuf_dir = ../outbuf/
+wordcache_dir = ../wordcache/
+corpusindex_dir = ../corpusindex/
+postings_dir = ../postings/
+simjoin_dir = ../simjoin/
+corpusgen_dir = ../corpusgen/
+CC = gcc
+CFLAGS = -std=c2x \
+  -Wall -Wconversion -Werror -Wextra -Wpedantic -Wwrite-strings \
+  -O2 \
+  -I$(jdis_dir) -I$(hashtable_dir) -I$(lexicon_dir) -I$(wordset_dir) \
+  -I$(bitmatrix_dir) -I$(minhash_dir) \
+  -I$(lsh_dir) -I$(threadpool_dir) -I$(tokenizer_dir) \
+  -I$(arena_dir) -I$(slab_dir) -I$(strsort_dir) \
+  -I$(outbuf_dir) -I$(wordcache_dir) -I$(corpusindex_dir) \
+  -I$(postings_dir) -I$(simjoin_dir) -I$(corpusgen_dir) -pthread \
+  -DHASHTABLE_STATS=0
+vpath %.c $(jdis_dir) $(hashtable_dir) $(lexicon_dir) \
+  $(wordset_dir) $(bitmatrix_dir) $(minhash_dir) $(lsh_dir) $(threadpool_dir) \
+  $(tokenizer_dir) $(arena_dir) $(slab_dir) $(strsort_dir) $(outbuf_dir) \
+  $(wordcache_dir) $(corpusindex_dir) $(postings_dir) $(simjoin_dir) \
+  $(corpusgen_dir)
+vpath %.h $(jdis_dir) $(hashtable_dir) $(lexicon_dir) \
+  $(wordset_dir) $(bitmatrix_dir) $(minhash_dir) $(lsh_dir) $(threadpool_dir) \
+  $(tokenizer_dir) $(arena_dir) $(slab_dir) $(strsort_dir) $(outbuf_dir) \
+  $(wordcache_dir) $(corpusindex_dir) $(postings_dir) $(simjoin_dir) \
+  $(corpusgen_dir)
+# hashtable_impl : implantation du module hashtable, hashtable (chainage
+#   séparé) ou hashtable_oa (adressage ouvert), voir hashtable_ip.h.
+hashtable_impl = hashtable
+# module_objects : fichiers objets de jdis, hors programme principal.
+module_objects = jdis.o $(hashtable_impl).o lexicon.o wordset.o \
+  bitmatrix.o minhash.o lsh.o threadpool.o tokenizer.o arena.o slab.o \
+  strsort.o outbuf.o wordcache.o corpusindex.o postings.o simjoin.o
+LDLIBS = -pthread
+
+jdis.o: jdis.c jdis.h hashtable.h hashtable_ip.h lexicon.h \
+  minhash.h wordset.h bitmatrix.h lsh.h threadpool.h tokenizer.h \
+  arena.h outbuf.h strsort.h wordcache.h corpusindex.h postings.h \
+  simjoin.h
+hashtable.o: hashtable.c hashtable.h hashtable_ip.h slab.h
+hashtable_oa.o: hashtable_oa.c hashtable.h hashtable_ip.h
+lexicon.o: lexicon.c lexicon.h arena.h hashtable.h hashtable_ip.h
+wordset.o: wordset.c wordset.h
+bitmatrix.o: bitmatrix.c bitmatrix.h wordset.h
+minhash.o: minhash.c minhash.h
+lsh.o: lsh.c lsh.h minhash.h
+threadpool.o: threadpool.c threadpool.h
+tokenizer.o: tokenizer.c tokenizer.h
+arena.o: arena.c arena.h
+slab.o: slab.c slab.h
+strsort.o: strsort.c strsort.h threadpool.h
+outbuf.o: outbuf.c outbuf.h
+wordcache.o: wordcache.c wordcache.h
+corpusindex.o: corpusindex.c corpusindex.h hashtable.h hashtable_ip.h
+postings.o: postings.c postings.h bitmatrix.h wordset.h
+simjoin.o: simjoin.c simjoin.h wordset.h
+corpusgen.o: corpusgen.c corpusgen.h
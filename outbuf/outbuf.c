@@ -0,0 +1,143 @@
+//  outbuf.c : partie implantation du module outbuf.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "outbuf.h"
+
+//  OUTBUF__CAPACITY : capacité en octets du tampon.
+#define OUTBUF__CAPACITY ((size_t) 1 << 20)
+
+//  OUTBUF__FIXED4_LIMIT : borne stricte des valeurs de x * 10000 pour
+//    lesquelles outbuf_put_fixed4 procède par calcul entier. Pour un float x,
+//    le produit de x par 10000 est exact en double : en deçà de cette borne,
+//    l'arrondi à l'entier le plus proche (au pair en cas d'égalité, comme
+//    printf) l'est donc aussi.
+#define OUTBUF__FIXED4_LIMIT 1e14
+
+//  struct outbuf, outbuf : les length premiers des OUTBUF__CAPACITY octets du
+//    tableau data sont en attente d'écriture sur le descripteur fd. failed
+//    indique qu'une écriture a échoué.
+struct outbuf {
+  int fd;
+  bool failed;
+  size_t length;
+  char data[];
+};
+
+//  outbuf__write_all : écrit sur le descripteur associé à ob les n octets de
+//    la zone pointée par s, en reprenant les écritures partielles ou
+//    interrompues. Renvoie 0 en cas de succès, -1 en cas d'échec.
+static int outbuf__write_all(outbuf *ob, const char *s, size_t n) {
+  while (n > 0) {
+    ssize_t r = write(ob->fd, s, n);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ob->failed = true;
+      return -1;
+    }
+    s += r;
+    n -= (size_t) r;
+  }
+  return 0;
+}
+
+outbuf *outbuf_empty(int fd) {
+  outbuf *ob = malloc(sizeof *ob + OUTBUF__CAPACITY);
+  if (ob == nullptr) {
+    return nullptr;
+  }
+  ob->fd = fd;
+  ob->failed = false;
+  ob->length = 0;
+  return ob;
+}
+
+void outbuf_dispose(outbuf **obptr) {
+  if (*obptr == nullptr) {
+    return;
+  }
+  outbuf_flush(*obptr);
+  free(*obptr);
+  *obptr = nullptr;
+}
+
+int outbuf_flush(outbuf *ob) {
+  if (ob->failed) {
+    return -1;
+  }
+  size_t n = ob->length;
+  ob->length = 0;
+  return outbuf__write_all(ob, ob->data, n);
+}
+
+int outbuf_write(outbuf *ob, const char *s, size_t n) {
+  if (ob->failed) {
+    return -1;
+  }
+  if (n > OUTBUF__CAPACITY - ob->length) {
+    if (outbuf_flush(ob) != 0) {
+      return -1;
+    }
+    if (n > OUTBUF__CAPACITY) {
+      return outbuf__write_all(ob, s, n);
+    }
+  }
+  memcpy(ob->data + ob->length, s, n);
+  ob->length += n;
+  return 0;
+}
+
+int outbuf_puts(outbuf *ob, const char *s) {
+  return outbuf_write(ob, s, strlen(s));
+}
+
+int outbuf_putc(outbuf *ob, char c) {
+  if (ob->failed) {
+    return -1;
+  }
+  if (ob->length == OUTBUF__CAPACITY && outbuf_flush(ob) != 0) {
+    return -1;
+  }
+  ob->data[ob->length] = c;
+  ob->length += 1;
+  return 0;
+}
+
+int outbuf_put_fixed4(outbuf *ob, float x) {
+  double v = (double) x * 10000.0;
+  if (signbit(x) || !(v < OUTBUF__FIXED4_LIMIT)) {
+    char t[64];
+    int m = snprintf(t, sizeof t, "%.4f", (double) x);
+    if (m < 0 || (size_t) m >= sizeof t) {
+      return -1;
+    }
+    return outbuf_write(ob, t, (size_t) m);
+  }
+  uint64_t k = (uint64_t) v;
+  double f = v - (double) k;
+  if (f > 0.5 || (f == 0.5 && k % 2 == 1)) {
+    k += 1;
+  }
+  char t[24];
+  size_t i = sizeof t;
+  for (int j = 0; j < 4; ++j) {
+    t[--i] = (char) ('0' + k % 10);
+    k /= 10;
+  }
+  t[--i] = '.';
+  do {
+    t[--i] = (char) ('0' + k % 10);
+    k /= 10;
+  } while (k != 0);
+  return outbuf_write(ob, t + i, sizeof t - i);
+}
@@ -0,0 +1,54 @@
+//  outbuf.h : partie interface d'un module d'écriture en bloc sur un
+//    descripteur de fichier.
+//  Fonctionnement général :
+//  - les octets à écrire sont accumulés dans un grand tampon, vidé par
+//    appels à write lorsqu'il est plein, lors d'une demande explicite et lors
+//    de la libération ;
+//  - le module ne partage pas le tampon de stdio : si des données ont été
+//    écrites sur le même fichier au moyen de stdio, ce tampon doit être vidé
+//    (par fflush par exemple) avant la première écriture ;
+//  - après un échec de write, les écritures suivantes sont sans effet et les
+//    fonctions d'écriture renvoient toutes -1.
+
+#ifndef OUTBUF__H
+#define OUTBUF__H
+
+#include <stddef.h>
+
+//  struct outbuf, outbuf : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un tampon d'écriture.
+typedef struct outbuf outbuf;
+
+//  outbuf_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouveau tampon d'écriture, initialement vide, sur le descripteur de
+//    fichier fd. Renvoie un pointeur nul en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers le contrôleur associé au tampon.
+extern outbuf *outbuf_empty(int fd);
+
+//  outbuf_dispose : sans effet si *obptr vaut un pointeur nul. Vide sinon le
+//    tampon associé à *obptr, libère les ressources allouées à sa gestion
+//    puis affecte un pointeur nul à *obptr.
+extern void outbuf_dispose(outbuf **obptr);
+
+//  outbuf_flush : écrit sur le descripteur du tampon associé à ob le contenu
+//    de ce tampon, puis le vide. Renvoie 0 en cas de succès, -1 en cas
+//    d'échec d'écriture.
+extern int outbuf_flush(outbuf *ob);
+
+//  outbuf_write : ajoute au tampon associé à ob les n octets de la zone
+//    pointée par s. Renvoie 0 en cas de succès, -1 en cas d'échec d'écriture.
+extern int outbuf_write(outbuf *ob, const char *s, size_t n);
+
+//  outbuf_puts : comme outbuf_write, pour les octets de la chaîne pointée par
+//    s, caractère nul exclu.
+extern int outbuf_puts(outbuf *ob, const char *s);
+
+//  outbuf_putc : comme outbuf_write, pour le seul octet c.
+extern int outbuf_putc(outbuf *ob, char c);
+
+//  outbuf_put_fixed4 : ajoute au tampon associé à ob l'écriture décimale de x
+//    avec quatre décimales, identique à celle qu'en donne printf avec le
+//    format "%.4f". Renvoie 0 en cas de succès, -1 en cas d'échec d'écriture.
+extern int outbuf_put_fixed4(outbuf *ob, float x);
+
+#endif
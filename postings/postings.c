@@ -0,0 +1,246 @@
+//  postings.c : partie implantation du module postings.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmatrix.h"
+#include "postings.h"
+
+//  struct postings, postings : sets est le tableau des nrows ensembles des
+//    lignes. La liste des lignes de la colonne w occupe les composantes
+//    d'indices offsets[w] à offsets[w + 1] exclu du tableau files ; heavy[w]
+//    indique si la colonne w est celle d'un mot fréquent, dont la liste est
+//    alors vide. matrix est la matrice binaire des mots fréquents, ou nullptr
+//    s'il n'y en a pas.
+struct postings {
+  wordset **sets;
+  size_t nrows;
+  size_t *offsets;
+  uint32_t *files;
+  bool *heavy;
+  bitmatrix *matrix;
+};
+
+//  postings__frequencies : renvoie le tableau des fréquences des ncols
+//    identifiants dans les nrows ensembles sets, alloué dynamiquement, ou
+//    nullptr en cas de dépassement de capacité.
+static size_t *postings__frequencies(wordset **sets, size_t nrows,
+    size_t ncols) {
+  size_t *df = calloc(ncols + 1, sizeof *df);
+  if (df == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < nrows; ++i) {
+    if (sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(sets[i]);
+    size_t n = wordset_count(sets[i]);
+    for (size_t k = 0; k < n; ++k) {
+      df[ids[k]] += 1;
+    }
+  }
+  return df;
+}
+
+//  postings__is_heavy : indique si un mot de fréquence f parmi nrows lignes
+//    est compté au moyen de la matrice binaire.
+static bool postings__is_heavy(size_t f, size_t nrows) {
+  return f > 1 && f > nrows / POSTINGS_HEAVY_SHARE;
+}
+
+double postings_cost(wordset **sets, size_t nrows, size_t ncols) {
+  size_t *df = postings__frequencies(sets, nrows, ncols);
+  if (df == nullptr) {
+    return -1.0;
+  }
+  double cost = 0.0;
+  size_t num_heavy = 0;
+  for (size_t w = 0; w < ncols; ++w) {
+    cost += (double) df[w];
+    if (postings__is_heavy(df[w], nrows)) {
+      num_heavy += 1;
+    } else {
+      cost += (double) df[w] * ((double) df[w] - 1.0) / 2.0;
+    }
+  }
+  free(df);
+  if (num_heavy > 0) {
+    cost += (double) nrows * (double) (nrows - 1) / 2.0
+        * (double) (bitmatrix_size(1, num_heavy) / sizeof(uint64_t));
+  }
+  return cost;
+}
+
+//  postings__build_heavy : tente de construire la matrice binaire des mots
+//    fréquents de l'index p, dont les colonnes sont numérotées dans l'ordre
+//    croissant des identifiants, num_heavy étant leur nombre. Renvoie 0 en cas
+//    de succès, -1 en cas de dépassement de capacité.
+static int postings__build_heavy(postings *p, size_t ncols,
+    size_t num_heavy) {
+  uint32_t *column = malloc(ncols * sizeof *column);
+  wordset **rows = calloc(p->nrows, sizeof *rows);
+  int r = -1;
+  if (column == nullptr || rows == nullptr) {
+    goto cleanup;
+  }
+  uint32_t c = 0;
+  for (size_t w = 0; w < ncols; ++w) {
+    column[w] = c;
+    c += p->heavy[w];
+  }
+  for (size_t i = 0; i < p->nrows; ++i) {
+    if (p->sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(p->sets[i]);
+    size_t n = wordset_count(p->sets[i]);
+    for (size_t k = 0; k < n; ++k) {
+      if (!p->heavy[ids[k]]) {
+        continue;
+      }
+      if (rows[i] == nullptr) {
+        rows[i] = wordset_empty();
+        if (rows[i] == nullptr) {
+          goto cleanup;
+        }
+      }
+      if (wordset_put(rows[i], column[ids[k]]) != 0) {
+        goto cleanup;
+      }
+    }
+  }
+  p->matrix = bitmatrix_build(rows, p->nrows, num_heavy);
+  r = p->matrix == nullptr ? -1 : 0;
+cleanup:
+  for (size_t i = 0; rows != nullptr && i < p->nrows; ++i) {
+    wordset_dispose(&rows[i]);
+  }
+  free(rows);
+  free(column);
+  return r;
+}
+
+postings *postings_build(wordset **sets, size_t nrows, size_t ncols) {
+  if (nrows > UINT32_MAX) {
+    return nullptr;
+  }
+  postings *p = malloc(sizeof *p);
+  if (p == nullptr) {
+    return nullptr;
+  }
+  *p = (postings) {
+    .sets = sets,
+    .nrows = nrows,
+    .offsets = postings__frequencies(sets, nrows, ncols),
+    .files = nullptr,
+    .heavy = malloc((ncols + 1) * sizeof *p->heavy),
+    .matrix = nullptr,
+  };
+  if (p->offsets == nullptr || p->heavy == nullptr) {
+    postings_dispose(&p);
+    return nullptr;
+  }
+  //  Les fréquences sont changées en positions de fin de liste, puis chaque
+  //    ligne est rangée en décrémentant ces positions, en partant de la
+  //    dernière : les listes sont ainsi croissantes et chaque position est à
+  //    la fin ramenée au début de sa liste.
+  size_t total = 0;
+  size_t num_heavy = 0;
+  for (size_t w = 0; w < ncols; ++w) {
+    p->heavy[w] = postings__is_heavy(p->offsets[w], nrows);
+    num_heavy += p->heavy[w];
+    if (!p->heavy[w]) {
+      total += p->offsets[w];
+    }
+    p->offsets[w] = total;
+  }
+  p->offsets[ncols] = total;
+  p->files = malloc((total == 0 ? 1 : total) * sizeof *p->files);
+  if (p->files == nullptr) {
+    postings_dispose(&p);
+    return nullptr;
+  }
+  for (size_t i = nrows; i-- > 0; ) {
+    if (sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(sets[i]);
+    size_t n = wordset_count(sets[i]);
+    for (size_t k = 0; k < n; ++k) {
+      if (!p->heavy[ids[k]]) {
+        p->offsets[ids[k]] -= 1;
+        p->files[p->offsets[ids[k]]] = (uint32_t) i;
+      }
+    }
+  }
+  if (num_heavy > 0 && postings__build_heavy(p, ncols, num_heavy) != 0) {
+    postings_dispose(&p);
+    return nullptr;
+  }
+  return p;
+}
+
+void postings_dispose(postings **pptr) {
+  if (*pptr == nullptr) {
+    return;
+  }
+  bitmatrix_dispose(&(*pptr)->matrix);
+  free((*pptr)->heavy);
+  free((*pptr)->files);
+  free((*pptr)->offsets);
+  free(*pptr);
+  *pptr = nullptr;
+}
+
+//  postings__after : renvoie l'adresse du premier élément strictement
+//    supérieur à i du tableau croissant de files de length éléments, ou
+//    files + length s'il n'en existe pas.
+static const uint32_t *postings__after(const uint32_t *files, size_t length,
+    size_t i) {
+  size_t lo = 0;
+  size_t hi = length;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (files[mid] <= i) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return files + lo;
+}
+
+void postings_intersection_counts(const postings *p, size_t i0, size_t i1,
+    size_t *counts) {
+  size_t n = p->nrows;
+  if (p->matrix != nullptr) {
+    bitmatrix_intersection_counts(p->matrix, i0, i1, counts);
+  } else {
+    for (size_t i = i0; i < i1; ++i) {
+      for (size_t k = i + 1; k < n; ++k) {
+        counts[(i - i0) * n + k] = 0;
+      }
+    }
+  }
+  for (size_t i = i0; i < i1; ++i) {
+    if (p->sets[i] == nullptr) {
+      continue;
+    }
+    size_t *row = counts + (i - i0) * n;
+    const uint32_t *ids = wordset_ids(p->sets[i]);
+    size_t m = wordset_count(p->sets[i]);
+    for (size_t k = 0; k < m; ++k) {
+      if (p->heavy[ids[k]]) {
+        continue;
+      }
+      const uint32_t *first = p->files + p->offsets[ids[k]];
+      const uint32_t *last = p->files + p->offsets[ids[k] + 1];
+      for (const uint32_t *f = postings__after(first, (size_t) (last - first),
+          i); f < last; ++f) {
+        row[*f] += 1;
+      }
+    }
+  }
+}
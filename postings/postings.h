@@ -0,0 +1,64 @@
+//  postings.h : partie interface d'un module d'index inversé fichiers × mots,
+//    pour le calcul en bloc des cardinaux des intersections de tous les
+//    couples d'ensembles de mots lorsque ceux-ci ont peu de mots en commun.
+//  Fonctionnement général :
+//  - l'index associe à chaque identifiant de mot (voir lexicon.h) la liste
+//    croissante, en entiers de 32 bits, des fichiers qui le contiennent ;
+//  - les cardinaux des intersections d'un fichier et des fichiers suivants
+//    s'obtiennent en parcourant, pour chacun de ses mots, la fin de la liste
+//    du mot et en incrémentant le compteur de chaque fichier rencontré : le
+//    coût est la somme des carrés des fréquences des mots, indépendamment du
+//    nombre de couples sans mot commun ;
+//  - les mots fréquents, présents dans plus d'un fichier sur
+//    POSTINGS_HEAVY_SHARE, coûteraient à eux seuls le carré de leur
+//    fréquence : ils sont comptés à part, au moyen d'une matrice binaire
+//    restreinte à ces mots (voir bitmatrix.h) ;
+//  - l'index fait référence aux ensembles dont il est construit, qui ne
+//    doivent pas être modifiés ni libérés tant qu'il est utilisé ;
+//  - les fonctions de comptage peuvent être appelées simultanément par
+//    plusieurs fils d'exécution.
+
+#ifndef POSTINGS__H
+#define POSTINGS__H
+
+#include <stddef.h>
+#include "wordset.h"
+
+//  POSTINGS_HEAVY_SHARE : un mot présent dans plus de nrows /
+//    POSTINGS_HEAVY_SHARE fichiers est compté au moyen de la matrice binaire.
+//    Parcourir la liste d'un mot de fréquence f coûte de l'ordre de f² / 2
+//    incréments pour l'ensemble des lignes, une colonne de la matrice binaire
+//    nrows² / 128 opérations sur des mots de 64 bits : au-delà de
+//    f = nrows / 8, la colonne est moins coûteuse.
+#define POSTINGS_HEAVY_SHARE 8
+
+//  struct postings, postings : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour gérer un index inversé.
+typedef struct postings postings;
+
+//  postings_cost : renvoie une estimation du nombre d'opérations élémentaires
+//    nécessaires pour construire l'index des nrows ensembles sets, dont les
+//    identifiants sont strictement inférieurs à ncols, et calculer les
+//    cardinaux des intersections de tous leurs couples. Renvoie -1 en cas de
+//    dépassement de capacité.
+extern double postings_cost(wordset **sets, size_t nrows, size_t ncols);
+
+//  postings_build : tente d'allouer un index inversé de nrows lignes et ncols
+//    colonnes dont la ligne i est l'ensemble sets[i] (une ligne vide si
+//    sets[i] vaut un pointeur nul). Les identifiants doivent être strictement
+//    inférieurs à ncols, et les ensembles triés. Renvoie un pointeur nul si
+//    nrows dépasse UINT32_MAX ou en cas de dépassement de capacité. Renvoie
+//    sinon un pointeur vers le contrôleur associé à l'index.
+extern postings *postings_build(wordset **sets, size_t nrows, size_t ncols);
+
+//  postings_dispose : sans effet si *pptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de l'index associé à *pptr puis
+//    affecte un pointeur nul à *pptr.
+extern void postings_dispose(postings **pptr);
+
+//  postings_intersection_counts : comme bitmatrix_intersection_counts, pour
+//    l'index associé à p.
+extern void postings_intersection_counts(const postings *p, size_t i0,
+    size_t i1, size_t *counts);
+
+#endif
@@ -0,0 +1,500 @@
+//  simjoin.c : partie implantation du module simjoin.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "simjoin.h"
+
+//  simjoin__entry : occurrence d'un mot dans le préfixe d'un ensemble.
+//    Membres :
+//      row : indice de l'ensemble.
+//      position : position du mot dans l'ensemble réécrit dans l'ordre
+//                 global.
+typedef struct {
+  uint32_t row;
+  uint32_t position;
+} simjoin__entry;
+
+//  struct simjoin, simjoin : threshold est le seuil de similarité, counts le
+//    tableau des cardinaux des nrows ensembles. L'ensemble i, réécrit en
+//    rangs dans l'ordre global, occupe les composantes d'indices
+//    row_offsets[i] à row_offsets[i + 1] exclu du tableau ranked ; son
+//    préfixe en est le début. La liste du mot de rang r occupe les
+//    composantes d'indices offsets[r] à offsets[r + 1] exclu du tableau
+//    entries. empties est le tableau croissant des num_empties indices des
+//    ensembles vides.
+struct simjoin {
+  size_t nrows;
+  double threshold;
+  size_t *counts;
+  size_t *row_offsets;
+  uint32_t *ranked;
+  size_t *offsets;
+  simjoin__entry *entries;
+  size_t *empties;
+  size_t num_empties;
+};
+
+//  simjoin__state : état d'un ensemble k au cours de la recherche des couples
+//    d'un ensemble i. Les membres sont regroupés pour qu'une rencontre
+//    n'accède qu'à une ligne de cache.
+//    Membres :
+//      mark : vaut i + 1 si l'ensemble k a déjà été rencontré. Les autres
+//             membres sont alors significatifs.
+//      overlap : nombre de mots communs des préfixes comptés jusque-là, ou 0
+//                si le couple est écarté.
+//      need : nombre minimal de mots communs du couple.
+//      next_x, next_y : positions qui suivent le dernier mot commun compté
+//                       dans l'ensemble i et dans l'ensemble k.
+typedef struct {
+  size_t mark;
+  size_t overlap;
+  size_t need;
+  size_t next_x;
+  size_t next_y;
+} simjoin__state;
+
+//  struct simjoin_probe, simjoin_probe : states est le tableau des états des
+//    ensembles, candidates celui des ensembles rencontrés, matches celui des
+//    couples retenus.
+struct simjoin_probe {
+  simjoin__state *states;
+  size_t *candidates;
+  simjoin_match *matches;
+};
+
+//  simjoin__inverted : index inversé complet des ensembles, dont sont tirés
+//    l'ordre global et les ensembles réécrits dans cet ordre.
+//    Membres :
+//      order : identifiants des mots par rang croissant.
+//      offsets : la liste croissante des ensembles contenant le mot
+//                d'identifiant w occupe les composantes d'indices offsets[w]
+//                à offsets[w + 1] exclu du tableau rows.
+//      rows : listes des ensembles.
+typedef struct {
+  uint32_t *order;
+  size_t *offsets;
+  uint32_t *rows;
+} simjoin__inverted;
+
+//  simjoin__threshold : renvoie le seuil de similarité associé à la
+//    dissimilarité maximale max_distance.
+static double simjoin__threshold(float max_distance) {
+  return 1.0 - (double) max_distance - SIMJOIN_SLACK;
+}
+
+//  simjoin__ceil : renvoie le plus petit entier naturel supérieur ou égal au
+//    réel x.
+static size_t simjoin__ceil(double x) {
+  if (x <= 0.0) {
+    return 0;
+  }
+  size_t n = (size_t) x;
+  return (double) n < x ? n + 1 : n;
+}
+
+//  simjoin__prefix_length : renvoie la longueur du préfixe d'un ensemble de
+//    cardinal n pour le seuil de similarité t : n moins le nombre minimal de
+//    mots communs avec un ensemble de même cardinal, plus un. Ce nombre
+//    minimal vaut au moins un, une dissimilarité inférieure à 1 exigeant un
+//    mot commun.
+static size_t simjoin__prefix_length(size_t n, double t) {
+  size_t need = simjoin__ceil(t * (double) n);
+  if (need == 0) {
+    need = 1;
+  }
+  return need > n ? 0 : n - need + 1;
+}
+
+//  simjoin__dispose_inverted : libère les tableaux de l'index inv.
+static void simjoin__dispose_inverted(simjoin__inverted *inv) {
+  free(inv->rows);
+  free(inv->offsets);
+  free(inv->order);
+}
+
+//  simjoin__invert : tente de construire l'index inversé complet inv des
+//    nrows ensembles sets dont les identifiants sont strictement inférieurs à
+//    ncols. Les rangs sont attribués par un tri par dénombrement des
+//    fréquences ; les listes sont remplies comme dans postings_build. Renvoie
+//    0 en cas de succès, -1 en cas de dépassement de capacité.
+static int simjoin__invert(simjoin__inverted *inv, wordset **sets,
+    size_t nrows, size_t ncols) {
+  size_t *start = calloc(nrows + 2, sizeof *start);
+  *inv = (simjoin__inverted) {
+    .order = malloc((ncols + 1) * sizeof *inv->order),
+    .offsets = calloc(ncols + 1, sizeof *inv->offsets),
+    .rows = nullptr,
+  };
+  if (start == nullptr || inv->order == nullptr || inv->offsets == nullptr) {
+    goto error;
+  }
+  for (size_t i = 0; i < nrows; ++i) {
+    if (sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(sets[i]);
+    size_t n = wordset_count(sets[i]);
+    for (size_t k = 0; k < n; ++k) {
+      inv->offsets[ids[k]] += 1;
+    }
+  }
+  for (size_t w = 0; w < ncols; ++w) {
+    start[inv->offsets[w] + 1] += 1;
+  }
+  for (size_t f = 1; f < nrows + 2; ++f) {
+    start[f] += start[f - 1];
+  }
+  size_t total = 0;
+  for (size_t w = 0; w < ncols; ++w) {
+    inv->order[start[inv->offsets[w]]] = (uint32_t) w;
+    start[inv->offsets[w]] += 1;
+    total += inv->offsets[w];
+    inv->offsets[w] = total;
+  }
+  inv->offsets[ncols] = total;
+  inv->rows = malloc((total + 1) * sizeof *inv->rows);
+  if (inv->rows == nullptr) {
+    goto error;
+  }
+  for (size_t i = nrows; i-- > 0; ) {
+    if (sets[i] == nullptr) {
+      continue;
+    }
+    const uint32_t *ids = wordset_ids(sets[i]);
+    size_t n = wordset_count(sets[i]);
+    for (size_t k = 0; k < n; ++k) {
+      inv->offsets[ids[k]] -= 1;
+      inv->rows[inv->offsets[ids[k]]] = (uint32_t) i;
+    }
+  }
+  free(start);
+  return 0;
+error:
+  free(start);
+  simjoin__dispose_inverted(inv);
+  return -1;
+}
+
+double simjoin_cost(wordset **sets, size_t nrows, size_t ncols,
+    float max_distance) {
+  if (nrows > UINT32_MAX) {
+    return -1.0;
+  }
+  double t = simjoin__threshold(max_distance);
+  simjoin__inverted inv;
+  if (simjoin__invert(&inv, sets, nrows, ncols) != 0) {
+    return -1.0;
+  }
+  size_t *filled = calloc(nrows + 1, sizeof *filled);
+  size_t *limits = malloc((nrows + 1) * sizeof *limits);
+  double cost = -1.0;
+  if (filled == nullptr || limits == nullptr) {
+    goto cleanup;
+  }
+  cost = 0.0;
+  size_t num_empties = 0;
+  for (size_t i = 0; i < nrows; ++i) {
+    size_t n = sets[i] == nullptr ? 0 : wordset_count(sets[i]);
+    if (sets[i] != nullptr && n == 0) {
+      num_empties += 1;
+    }
+    limits[i] = simjoin__prefix_length(n, t);
+    cost += (double) n;
+  }
+  for (size_t r = 0; r < ncols; ++r) {
+    size_t w = inv.order[r];
+    size_t c = 0;
+    for (size_t q = inv.offsets[w]; q < inv.offsets[w + 1]; ++q) {
+      size_t row = inv.rows[q];
+      if (filled[row] < limits[row]) {
+        c += 1;
+      }
+      filled[row] += 1;
+    }
+    cost += (double) c * ((double) c - 1.0) / 2.0;
+  }
+  cost += (double) num_empties * ((double) num_empties - 1.0) / 2.0;
+cleanup:
+  free(limits);
+  free(filled);
+  simjoin__dispose_inverted(&inv);
+  return cost;
+}
+
+simjoin *simjoin_build(wordset **sets, size_t nrows, size_t ncols,
+    float max_distance) {
+  if (nrows > UINT32_MAX) {
+    return nullptr;
+  }
+  simjoin *sj = malloc(sizeof *sj);
+  if (sj == nullptr) {
+    return nullptr;
+  }
+  *sj = (simjoin) {
+    .nrows = nrows,
+    .threshold = simjoin__threshold(max_distance),
+    .counts = malloc((nrows + 1) * sizeof *sj->counts),
+    .row_offsets = malloc((nrows + 1) * sizeof *sj->row_offsets),
+    .ranked = nullptr,
+    .offsets = malloc((ncols + 1) * sizeof *sj->offsets),
+    .entries = nullptr,
+    .empties = malloc((nrows + 1) * sizeof *sj->empties),
+    .num_empties = 0,
+  };
+  simjoin__inverted inv;
+  if (simjoin__invert(&inv, sets, nrows, ncols) != 0) {
+    simjoin_dispose(&sj);
+    return nullptr;
+  }
+  size_t *filled = calloc(nrows + 1, sizeof *filled);
+  size_t *limits = malloc((nrows + 1) * sizeof *limits);
+  if (sj->counts == nullptr || sj->row_offsets == nullptr
+      || sj->offsets == nullptr || sj->empties == nullptr
+      || filled == nullptr || limits == nullptr) {
+    goto error;
+  }
+  size_t total = 0;
+  size_t total_prefix = 0;
+  for (size_t i = 0; i < nrows; ++i) {
+    sj->counts[i] = sets[i] == nullptr ? 0 : wordset_count(sets[i]);
+    if (sets[i] != nullptr && sj->counts[i] == 0) {
+      sj->empties[sj->num_empties] = i;
+      sj->num_empties += 1;
+    }
+    limits[i] = simjoin__prefix_length(sj->counts[i], sj->threshold);
+    sj->row_offsets[i] = total;
+    total += sj->counts[i];
+    total_prefix += limits[i];
+  }
+  sj->row_offsets[nrows] = total;
+  sj->ranked = malloc((total + 1) * sizeof *sj->ranked);
+  sj->entries = malloc((total_prefix + 1) * sizeof *sj->entries);
+  if (sj->ranked == nullptr || sj->entries == nullptr) {
+    goto error;
+  }
+  //  Les mots étant parcourus par rang croissant et leurs listes par indice
+  //    d'ensemble croissant, les ensembles sont réécrits dans l'ordre global
+  //    et les listes des préfixes sont remplies dans l'ordre, sans tri.
+  size_t num_entries = 0;
+  for (size_t r = 0; r < ncols; ++r) {
+    size_t w = inv.order[r];
+    sj->offsets[r] = num_entries;
+    for (size_t q = inv.offsets[w]; q < inv.offsets[w + 1]; ++q) {
+      size_t row = inv.rows[q];
+      sj->ranked[sj->row_offsets[row] + filled[row]] = (uint32_t) r;
+      if (filled[row] < limits[row]) {
+        sj->entries[num_entries] = (simjoin__entry) {
+          .row = (uint32_t) row,
+          .position = (uint32_t) filled[row],
+        };
+        num_entries += 1;
+      }
+      filled[row] += 1;
+    }
+  }
+  sj->offsets[ncols] = num_entries;
+  free(limits);
+  free(filled);
+  simjoin__dispose_inverted(&inv);
+  return sj;
+error:
+  free(limits);
+  free(filled);
+  simjoin__dispose_inverted(&inv);
+  simjoin_dispose(&sj);
+  return nullptr;
+}
+
+void simjoin_dispose(simjoin **sjptr) {
+  if (*sjptr == nullptr) {
+    return;
+  }
+  free((*sjptr)->empties);
+  free((*sjptr)->entries);
+  free((*sjptr)->offsets);
+  free((*sjptr)->ranked);
+  free((*sjptr)->row_offsets);
+  free((*sjptr)->counts);
+  free(*sjptr);
+  *sjptr = nullptr;
+}
+
+simjoin_probe *simjoin_probe_create(const simjoin *sj) {
+  simjoin_probe *pr = malloc(sizeof *pr);
+  if (pr == nullptr) {
+    return nullptr;
+  }
+  size_t n = sj->nrows + 1;
+  *pr = (simjoin_probe) {
+    .states = calloc(n, sizeof *pr->states),
+    .candidates = malloc(n * sizeof *pr->candidates),
+    .matches = malloc(n * sizeof *pr->matches),
+  };
+  if (pr->states == nullptr || pr->candidates == nullptr
+      || pr->matches == nullptr) {
+    simjoin_probe_dispose(&pr);
+    return nullptr;
+  }
+  return pr;
+}
+
+void simjoin_probe_dispose(simjoin_probe **prptr) {
+  if (*prptr == nullptr) {
+    return;
+  }
+  free((*prptr)->matches);
+  free((*prptr)->candidates);
+  free((*prptr)->states);
+  free(*prptr);
+  *prptr = nullptr;
+}
+
+//  simjoin__first_entry_after : renvoie l'adresse de la première occurrence
+//    d'indice d'ensemble strictement supérieur à i du tableau entries de
+//    length occurrences rangées par indice croissant, ou entries + length s'il
+//    n'en existe pas.
+static const simjoin__entry *simjoin__first_entry_after(
+    const simjoin__entry *entries, size_t length, size_t i) {
+  size_t lo = 0;
+  size_t hi = length;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (entries[mid].row <= i) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return entries + lo;
+}
+
+//  simjoin__first_row_after : comme simjoin__first_entry_after, pour le
+//    tableau croissant d'indices rows.
+static size_t simjoin__first_row_after(const size_t *rows, size_t length,
+    size_t i) {
+  size_t lo = 0;
+  size_t hi = length;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (rows[mid] <= i) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+//  simjoin__compare_rows : fonction de comparaison pour qsort des indices
+//    d'ensembles.
+static int simjoin__compare_rows(const void *a, const void *b) {
+  size_t x = *(const size_t *) a;
+  size_t y = *(const size_t *) b;
+  return (x > y) - (x < y);
+}
+
+//  simjoin__min : renvoie le minimum de a et b.
+static size_t simjoin__min(size_t a, size_t b) {
+  return a < b ? a : b;
+}
+
+//  simjoin__verify : renvoie le nombre de mots communs des ensembles
+//    réécrits x et y de cardinaux nx et ny, sachant que common mots communs
+//    précèdent les positions a de x et b de y, ou SIZE_MAX s'il est établi
+//    en cours de compte que ce nombre n'atteint pas need.
+static size_t simjoin__verify(const uint32_t *x, size_t nx, size_t a,
+    const uint32_t *y, size_t ny, size_t b, size_t common, size_t need) {
+  while (a < nx && b < ny) {
+    if (common + simjoin__min(nx - a, ny - b) < need) {
+      return SIZE_MAX;
+    }
+    if (x[a] < y[b]) {
+      a += 1;
+    } else if (x[a] > y[b]) {
+      b += 1;
+    } else {
+      common += 1;
+      a += 1;
+      b += 1;
+    }
+  }
+  return common < need ? SIZE_MAX : common;
+}
+
+size_t simjoin_matches(const simjoin *sj, simjoin_probe *pr,
+    size_t i, const simjoin_match **matches) {
+  *matches = pr->matches;
+  size_t nx = sj->counts[i];
+  if (nx == 0) {
+    //  Deux ensembles vides sont à dissimilarité nulle.
+    size_t e = simjoin__first_row_after(sj->empties, sj->num_empties, i);
+    if (e == 0 || sj->empties[e - 1] != i) {
+      return 0;
+    }
+    for (size_t q = e; q < sj->num_empties; ++q) {
+      pr->matches[q - e] = (simjoin_match) {
+        .row = sj->empties[q], .common = 0
+      };
+    }
+    return sj->num_empties - e;
+  }
+  double t = sj->threshold;
+  double share = t / (1.0 + t);
+  //  Filtre par longueur : les cardinaux des ensembles appariés à l'ensemble
+  //    i sont compris entre t · nx et nx / t.
+  size_t min_count = simjoin__ceil(t * (double) nx);
+  size_t max_count = t <= 0.0 ? SIZE_MAX : (size_t) ((double) nx / t);
+  const uint32_t *x = sj->ranked + sj->row_offsets[i];
+  size_t p = simjoin__prefix_length(nx, t);
+  size_t m = 0;
+  for (size_t px = 0; px < p; ++px) {
+    const simjoin__entry *first = sj->entries + sj->offsets[x[px]];
+    const simjoin__entry *last = sj->entries + sj->offsets[x[px] + 1];
+    for (const simjoin__entry *e = simjoin__first_entry_after(first,
+        (size_t) (last - first), i); e < last; ++e) {
+      simjoin__state *st = &pr->states[e->row];
+      size_t ny = sj->counts[e->row];
+      if (st->mark != i + 1) {
+        st->mark = i + 1;
+        st->overlap = 0;
+        if (ny < min_count || ny > max_count) {
+          continue;
+        }
+        st->need = simjoin__ceil(share * (double) (nx + ny));
+        pr->candidates[m] = e->row;
+        m += 1;
+      } else if (st->overlap == 0) {
+        continue;
+      }
+      //  Les mots communs non encore comptés suivent, dans les deux
+      //    ensembles, le mot commun qui vient d'être rencontré.
+      st->overlap += 1;
+      st->next_x = px + 1;
+      st->next_y = (size_t) e->position + 1;
+      if (st->overlap + simjoin__min(nx - st->next_x, ny - st->next_y)
+          < st->need) {
+        st->overlap = 0;
+      }
+    }
+  }
+  qsort(pr->candidates, m, sizeof *pr->candidates, simjoin__compare_rows);
+  size_t count = 0;
+  for (size_t q = 0; q < m; ++q) {
+    size_t k = pr->candidates[q];
+    const simjoin__state *st = &pr->states[k];
+    if (st->overlap == 0) {
+      continue;
+    }
+    size_t common = simjoin__verify(x, nx, st->next_x,
+        sj->ranked + sj->row_offsets[k], sj->counts[k], st->next_y,
+        st->overlap, st->need);
+    if (common != SIZE_MAX) {
+      pr->matches[count] = (simjoin_match) {
+        .row = k, .common = common
+      };
+      count += 1;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,106 @@
+//  simjoin.h : partie interface d'un module de jointure par similarité
+//    (filtrage par préfixe, par longueur et par position) des ensembles de
+//    mots, pour la recherche des seuls couples de fichiers dont la
+//    dissimilarité de Jaccard ne dépasse pas un seuil.
+//  Fonctionnement général :
+//  - les mots sont ordonnés globalement par fréquence croissante parmi les
+//    ensembles, puis par identifiant croissant (voir lexicon.h) ; chaque
+//    ensemble est réécrit dans cet ordre ;
+//  - deux ensembles x et y de dissimilarité au plus max_distance, c'est-à-dire
+//    de similarité au moins t = 1 - max_distance, ont au moins t · |x| mots
+//    communs : ils partagent donc au moins un mot de leurs préfixes, les
+//    |x| - ⌈t · |x|⌉ + 1 premiers mots de x et leur analogue pour y ;
+//  - l'index associe à chaque mot la liste croissante des ensembles qui le
+//    contiennent dans leur préfixe, avec sa position dans l'ensemble ;
+//  - les candidats d'un ensemble sont les ensembles suivants rencontrés dans
+//    les listes des mots de son préfixe, dont les mots communs des préfixes
+//    sont comptés au fil des rencontres ; ceux dont les cardinaux ou, à
+//    chaque rencontre, les mots communs comptés et les mots restant après le
+//    dernier d'entre eux ne permettent pas d'atteindre le nombre minimal de
+//    mots communs, t / (1 + t) · (|x| + |y|), sont écartés ;
+//  - les candidats restants sont vérifiés en comptant les mots communs
+//    suivant le dernier mot commun des préfixes, le compte étant abandonné
+//    dès que le nombre minimal ne peut plus être atteint ;
+//  - les couples retenus le sont avec leur nombre exact de mots communs : il
+//    revient à l'utilisateur d'en déduire leur dissimilarité et de la
+//    comparer au seuil ;
+//  - le seuil est abaissé de SIMJOIN_SLACK pour que les arrondis du calcul
+//    en flottants de la dissimilarité n'écartent aucun couple ;
+//  - l'index fait référence aux ensembles dont il est construit, qui ne
+//    doivent pas être modifiés ni libérés tant qu'il est utilisé ;
+//  - la recherche des couples peut être effectuée simultanément par
+//    plusieurs fils d'exécution, chacun disposant de son propre espace de
+//    travail.
+
+#ifndef SIMJOIN__H
+#define SIMJOIN__H
+
+#include <stddef.h>
+#include "wordset.h"
+
+//  SIMJOIN_SLACK : marge retranchée au seuil de similarité 1 - max_distance.
+#define SIMJOIN_SLACK 1e-6
+
+//  struct simjoin, simjoin : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour gérer l'index d'une jointure.
+typedef struct simjoin simjoin;
+
+//  struct simjoin_probe, simjoin_probe : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer l'espace de travail
+//    d'un fil recherchant des couples.
+typedef struct simjoin_probe simjoin_probe;
+
+//  simjoin_match : couple retenu par la jointure.
+//    Membres :
+//      row : indice du second ensemble du couple.
+//      common : nombre de mots communs aux deux ensembles.
+typedef struct {
+  size_t row;
+  size_t common;
+} simjoin_match;
+
+//  simjoin_cost : renvoie une estimation du nombre d'opérations élémentaires
+//    nécessaires pour construire l'index de la jointure des nrows ensembles
+//    sets, dont les identifiants sont strictement inférieurs à ncols, pour la
+//    dissimilarité maximale max_distance, et en parcourir les listes, hors
+//    vérification des candidats. Renvoie -1 en cas de dépassement de capacité.
+extern double simjoin_cost(wordset **sets, size_t nrows, size_t ncols,
+    float max_distance);
+
+//  simjoin_build : tente d'allouer l'index de la jointure des nrows
+//    ensembles sets (un ensemble sans mot ni couple si sets[i] vaut un
+//    pointeur nul) pour la dissimilarité maximale max_distance, qui doit être
+//    strictement inférieure à 1. Les identifiants doivent être strictement
+//    inférieurs à ncols. Renvoie un pointeur nul si nrows dépasse UINT32_MAX
+//    ou en cas de dépassement de capacité. Renvoie sinon un pointeur vers le
+//    contrôleur associé à l'index.
+extern simjoin *simjoin_build(wordset **sets, size_t nrows, size_t ncols,
+    float max_distance);
+
+//  simjoin_dispose : sans effet si *sjptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de l'index associé à *sjptr puis
+//    affecte un pointeur nul à *sjptr.
+extern void simjoin_dispose(simjoin **sjptr);
+
+//  simjoin_probe_create : tente d'allouer un espace de travail pour la
+//    recherche des couples de l'index associé à sj. Renvoie un pointeur nul
+//    en cas de dépassement de capacité, un pointeur vers le contrôleur associé
+//    à l'espace sinon.
+extern simjoin_probe *simjoin_probe_create(const simjoin *sj);
+
+//  simjoin_probe_dispose : sans effet si *prptr vaut un pointeur nul. Libère
+//    sinon les ressources allouées à la gestion de l'espace de travail associé
+//    à *prptr puis affecte un pointeur nul à *prptr.
+extern void simjoin_probe_dispose(simjoin_probe **prptr);
+
+//  simjoin_matches : recherche, au moyen de l'espace de travail associé à
+//    pr, les couples formés par l'ensemble d'indice i de l'index associé à sj
+//    et les ensembles d'indices k > i dont la dissimilarité avec lui peut ne
+//    pas dépasser max_distance ; tout autre couple a une dissimilarité
+//    supérieure. Affecte à *matches l'adresse du tableau de ces couples, par
+//    indice croissant, valide jusqu'au prochain appel avec pr, et renvoie leur
+//    nombre.
+extern size_t simjoin_matches(const simjoin *sj, simjoin_probe *pr,
+    size_t i, const simjoin_match **matches);
+
+#endif
@@ -0,0 +1,107 @@
+//  slab.c : partie implantation du module slab.
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "slab.h"
+
+//  SLAB__MIN_BLOCK_COUNT, SLAB__MAX_BLOCK_COUNT : nombre d'éléments du
+//    premier bloc d'une réserve et nombre au-delà duquel celui des blocs
+//    suivants, doublé à chaque nouveau bloc, cesse de croître.
+#define SLAB__MIN_BLOCK_COUNT 32
+#define SLAB__MAX_BLOCK_COUNT 8192
+
+//  slab__block : bloc d'éléments, chainé au bloc alloué avant lui par next.
+//    Les éléments débutent à l'adresse data.
+typedef struct slab__block slab__block;
+
+struct slab__block {
+  slab__block *next;
+  max_align_t data[];
+};
+
+//  slab__free_node : élément rendu, chainé au précédent élément rendu par
+//    next.
+typedef struct slab__free_node slab__free_node;
+
+struct slab__free_node {
+  slab__free_node *next;
+};
+
+//  struct slab, slab : size est la taille des éléments, arrondie à un multiple
+//    de l'alignement maximal. head repère la liste des blocs, le bloc courant
+//    en tête ; les avail éléments non encore distribués du bloc courant
+//    débutent à l'adresse cursor. freelist repère la liste des éléments
+//    rendus. block_count est le nombre d'éléments du prochain bloc.
+struct slab {
+  size_t size;
+  slab__block *head;
+  char *cursor;
+  size_t avail;
+  slab__free_node *freelist;
+  size_t block_count;
+};
+
+slab *slab_empty(size_t size) {
+  size_t a = alignof(max_align_t);
+  if (size == 0 || size > SIZE_MAX / 2 / SLAB__MAX_BLOCK_COUNT) {
+    return nullptr;
+  }
+  slab *sl = malloc(sizeof *sl);
+  if (sl == nullptr) {
+    return nullptr;
+  }
+  sl->size = (size + a - 1) / a * a;
+  sl->head = nullptr;
+  sl->cursor = nullptr;
+  sl->avail = 0;
+  sl->freelist = nullptr;
+  sl->block_count = SLAB__MIN_BLOCK_COUNT;
+  return sl;
+}
+
+void slab_dispose(slab **slptr) {
+  if (*slptr == nullptr) {
+    return;
+  }
+  slab__block *b = (*slptr)->head;
+  while (b != nullptr) {
+    slab__block *t = b;
+    b = b->next;
+    free(t);
+  }
+  free(*slptr);
+  *slptr = nullptr;
+}
+
+void *slab_alloc(slab *sl) {
+  if (sl->freelist != nullptr) {
+    slab__free_node *p = sl->freelist;
+    sl->freelist = p->next;
+    return p;
+  }
+  if (sl->avail == 0) {
+    slab__block *b
+      = malloc(sizeof(slab__block) + sl->block_count * sl->size);
+    if (b == nullptr) {
+      return nullptr;
+    }
+    b->next = sl->head;
+    sl->head = b;
+    sl->cursor = (char *) b->data;
+    sl->avail = sl->block_count;
+    if (sl->block_count < SLAB__MAX_BLOCK_COUNT) {
+      sl->block_count *= 2;
+    }
+  }
+  void *p = sl->cursor;
+  sl->cursor += sl->size;
+  sl->avail -= 1;
+  return p;
+}
+
+void slab_free(slab *sl, void *p) {
+  slab__free_node *q = p;
+  q->next = sl->freelist;
+  sl->freelist = q;
+}
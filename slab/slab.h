@@ -0,0 +1,41 @@
+//  slab.h : partie interface d'un module d'allocation d'éléments de taille
+//    fixe par blocs.
+//  Fonctionnement général :
+//  - les éléments sont découpés dans de grands blocs, dont la taille double
+//    d'un bloc au suivant jusqu'à un plafond ;
+//  - un élément rendu est chainé dans une liste d'éléments libres, réutilisés
+//    en priorité ;
+//  - les blocs ne sont rendus au système qu'à la libération du contrôleur,
+//    tous à la fois, quel que soit le nombre d'éléments alloués.
+
+#ifndef SLAB__H
+#define SLAB__H
+
+#include <stddef.h>
+
+//  struct slab, slab : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une réserve d'éléments.
+typedef struct slab slab;
+
+//  slab_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle réserve d'éléments de size octets, size > 0. Renvoie un pointeur
+//    nul en cas de dépassement de capacité. Renvoie sinon un pointeur vers le
+//    contrôleur associé à la réserve.
+extern slab *slab_empty(size_t size);
+
+//  slab_dispose : sans effet si *slptr vaut un pointeur nul. Libère sinon les
+//    ressources allouées à la gestion de la réserve associée à *slptr, y
+//    compris tous ses éléments, rendus ou non, puis affecte un pointeur nul à
+//    *slptr.
+extern void slab_dispose(slab **slptr);
+
+//  slab_alloc : tente d'allouer un élément de la réserve associée à sl.
+//    Renvoie un pointeur nul en cas de dépassement de capacité. Renvoie sinon
+//    l'adresse de l'élément, convenablement alignée pour tout type.
+extern void *slab_alloc(slab *sl);
+
+//  slab_free : rend l'élément d'adresse p, préalablement obtenue de
+//    slab_alloc pour la réserve associée à sl, à cette réserve.
+extern void slab_free(slab *sl, void *p);
+
+#endif
@@ -0,0 +1,286 @@
+//  strsort.c : partie implantation du module strsort.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strsort.h"
+#include "threadpool.h"
+
+//  STRSORT__INSERTION_THRESHOLD : nombre d'éléments en deçà duquel un segment
+//    est trié par insertion.
+#define STRSORT__INSERTION_THRESHOLD 16
+
+//  STRSORT__PARALLEL_MIN : nombre d'éléments en deçà duquel le tri n'est pas
+//    partagé entre plusieurs fils.
+#define STRSORT__PARALLEL_MIN ((size_t) 1 << 15)
+
+//  STRSORT__SEGMENTS_PER_THREAD : nombre de segments visé par fil lors du
+//    partage du tableau, afin que les fils restent occupés jusqu'au bout
+//    malgré l'inégalité des tailles des segments.
+#define STRSORT__SEGMENTS_PER_THREAD 16
+
+//  strsort__load : renvoie la tranche de rang depth de la clé key de length
+//    octets, c'est-à-dire l'entier dont les huit octets, du poids fort au
+//    poids faible, sont les octets de la clé à partir du rang depth, complétés
+//    par des octets nuls. Les clés ne contenant pas d'octet nul, l'octet de
+//    poids faible de la tranche est nul si et seulement si la clé se termine
+//    avant la fin de la tranche.
+static inline uint64_t strsort__load(const char *key, size_t length,
+    size_t depth) {
+  if (depth >= length) {
+    return 0;
+  }
+  const unsigned char *p = (const unsigned char *) key + depth;
+  size_t r = length - depth < 8 ? length - depth : 8;
+  uint64_t x = 0;
+#if defined __GNUC__ && defined __BYTE_ORDER__                                 \
+  && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (r == 8) {
+    memcpy(&x, p, 8);
+    return __builtin_bswap64(x);
+  }
+#endif
+  for (size_t i = 0; i < r; ++i) {
+    x |= (uint64_t) p[i] << (56 - 8 * i);
+  }
+  return x;
+}
+
+//  strsort__ended : renvoie true si la tranche prefix marque la fin de sa
+//    clé, false sinon.
+static inline bool strsort__ended(uint64_t prefix) {
+  return (prefix & 0xFF) == 0;
+}
+
+//  strsort__fill : affecte à chacun des n éléments de items la tranche de
+//    rang depth de sa clé.
+static void strsort__fill(strsort_item *items, size_t n, size_t depth) {
+  for (size_t k = 0; k < n; ++k) {
+    items[k].prefix = strsort__load(items[k].key, items[k].length, depth);
+  }
+}
+
+//  strsort__compare : compare les clés des éléments pointés par a et b, dont
+//    les depth premiers octets sont égaux et dont la tranche de rang depth est
+//    mémorisée. Renvoie une valeur strictement négative, nulle ou strictement
+//    positive selon que la clé de a est inférieure, égale ou supérieure à
+//    celle de b.
+static int strsort__compare(const strsort_item *a, const strsort_item *b,
+    size_t depth) {
+  if (a->prefix != b->prefix) {
+    return a->prefix < b->prefix ? -1 : 1;
+  }
+  if (strsort__ended(a->prefix)) {
+    return 0;
+  }
+  size_t d = depth + 8;
+  size_t la = a->length - d;
+  size_t lb = b->length - d;
+  int r = memcmp(a->key + d, b->key + d, la < lb ? la : lb);
+  if (r != 0) {
+    return r;
+  }
+  return (la > lb) - (la < lb);
+}
+
+//  strsort__insertion : trie par insertion les n éléments de items, sous les
+//    mêmes hypothèses que strsort__compare.
+static void strsort__insertion(strsort_item *items, size_t n, size_t depth) {
+  for (size_t i = 1; i < n; ++i) {
+    strsort_item e = items[i];
+    size_t j = i;
+    while (j > 0 && strsort__compare(&items[j - 1], &e, depth) > 0) {
+      items[j] = items[j - 1];
+      --j;
+    }
+    items[j] = e;
+  }
+}
+
+//  strsort__swap : échange les éléments pointés par a et b.
+static inline void strsort__swap(strsort_item *a, strsort_item *b) {
+  strsort_item t = *a;
+  *a = *b;
+  *b = t;
+}
+
+//  strsort__partition : choisit pour pivot la médiane des tranches du
+//    premier, du dernier et de l'élément du milieu des n éléments de items,
+//    n > 0, puis range ces éléments en trois parties : ceux de tranche
+//    inférieure au pivot dans [0, *ltptr), ceux de tranche égale dans
+//    [*ltptr, *gtptr), ceux de tranche supérieure dans [*gtptr, n). Renvoie le
+//    pivot.
+static uint64_t strsort__partition(strsort_item *items, size_t n,
+    size_t *ltptr, size_t *gtptr) {
+  uint64_t a = items[0].prefix;
+  uint64_t b = items[n / 2].prefix;
+  uint64_t c = items[n - 1].prefix;
+  uint64_t v = a < b
+      ? (b < c ? b : (a < c ? c : a))
+      : (a < c ? a : (b < c ? c : b));
+  size_t lt = 0;
+  size_t i = 0;
+  size_t gt = n;
+  while (i < gt) {
+    if (items[i].prefix < v) {
+      strsort__swap(&items[lt], &items[i]);
+      ++lt;
+      ++i;
+    } else if (items[i].prefix > v) {
+      --gt;
+      strsort__swap(&items[i], &items[gt]);
+    } else {
+      ++i;
+    }
+  }
+  *ltptr = lt;
+  *gtptr = gt;
+  return v;
+}
+
+//  strsort__segment : segment de n éléments débutant à items, dont les depth
+//    premiers octets des clés sont égaux et dont la tranche de rang depth est
+//    mémorisée.
+typedef struct {
+  strsort_item *items;
+  size_t n;
+  size_t depth;
+} strsort__segment;
+
+//  strsort__context : contexte du tri partagé entre plusieurs fils.
+//    Membres :
+//      segments, count, capacity : tableau dynamique des segments restant à
+//                                  trier, de longueur count et de capacité
+//                                  capacity.
+//      grain : nombre d'éléments en deçà duquel un segment n'est plus partagé.
+//      next : indice du prochain segment à attribuer à un fil.
+//      mutex : verrou protégeant next.
+typedef struct {
+  strsort__segment *segments;
+  size_t count;
+  size_t capacity;
+  size_t grain;
+  size_t next;
+  pthread_mutex_t mutex;
+} strsort__context;
+
+static void strsort__sort(strsort_item *items, size_t n, size_t depth,
+    strsort__context *ctx);
+
+//  strsort__defer : ajoute le segment de n éléments débutant à items, de rang
+//    depth, aux segments du contexte pointé par ctx. En cas de dépassement de
+//    capacité, le segment est trié sur-le-champ.
+static void strsort__defer(strsort__context *ctx, strsort_item *items,
+    size_t n, size_t depth) {
+  if (ctx->count == ctx->capacity) {
+    size_t c = ctx->capacity == 0 ? 64 : 2 * ctx->capacity;
+    strsort__segment *a = c > SIZE_MAX / sizeof *a ? nullptr
+        : realloc(ctx->segments, c * sizeof *a);
+    if (a == nullptr) {
+      strsort__sort(items, n, depth, nullptr);
+      return;
+    }
+    ctx->segments = a;
+    ctx->capacity = c;
+  }
+  ctx->segments[ctx->count] = (strsort__segment) {
+    items, n, depth
+  };
+  ctx->count += 1;
+}
+
+//  strsort__sort : trie les n éléments de items, dont les depth premiers
+//    octets des clés sont égaux et dont la tranche de rang depth est
+//    mémorisée. Si ctx n'est pas un pointeur nul, les segments d'au plus
+//    ctx->grain éléments sont confiés au contexte pointé par ctx au lieu
+//    d'être triés. Les deux plus petites des trois parties issues d'un
+//    partitionnement sont triées par appel récursif, la plus grande par
+//    itération, ce qui borne la profondeur de récursion par le logarithme de
+//    n.
+static void strsort__sort(strsort_item *items, size_t n, size_t depth,
+    strsort__context *ctx) {
+  while (n > STRSORT__INSERTION_THRESHOLD) {
+    if (ctx != nullptr && n <= ctx->grain) {
+      strsort__defer(ctx, items, n, depth);
+      return;
+    }
+    size_t lt;
+    size_t gt;
+    uint64_t v = strsort__partition(items, n, &lt, &gt);
+    strsort_item *eq = items + lt;
+    size_t neq = strsort__ended(v) ? 0 : gt - lt;
+    strsort_item *hi = items + gt;
+    size_t nhi = n - gt;
+    size_t nlo = lt;
+    if (neq >= nlo && neq >= nhi) {
+      strsort__sort(items, nlo, depth, ctx);
+      strsort__sort(hi, nhi, depth, ctx);
+      depth += 8;
+      strsort__fill(eq, neq, depth);
+      items = eq;
+      n = neq;
+    } else {
+      strsort__fill(eq, neq, depth + 8);
+      strsort__sort(eq, neq, depth + 8, ctx);
+      if (nlo >= nhi) {
+        strsort__sort(hi, nhi, depth, ctx);
+        n = nlo;
+      } else {
+        strsort__sort(items, nlo, depth, ctx);
+        items = hi;
+        n = nhi;
+      }
+    }
+  }
+  strsort__insertion(items, n, depth);
+}
+
+//  strsort__work : fonction de travail des fils, qui trient un à un les
+//    segments du contexte pointé par context jusqu'à leur épuisement.
+static void strsort__work(void *context, size_t worker) {
+  (void) worker;
+  strsort__context *ctx = context;
+  while (true) {
+    pthread_mutex_lock(&ctx->mutex);
+    size_t i = ctx->next;
+    if (i < ctx->count) {
+      ctx->next += 1;
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    if (i == ctx->count) {
+      return;
+    }
+    strsort__segment *s = &ctx->segments[i];
+    strsort__sort(s->items, s->n, s->depth, nullptr);
+  }
+}
+
+void strsort(strsort_item *items, size_t n, size_t num_threads) {
+  strsort__fill(items, n, 0);
+  strsort__context ctx = {
+    .segments = nullptr,
+    .count = 0,
+    .capacity = 0,
+    .grain = n / ((num_threads > 1 ? num_threads : 1)
+        * STRSORT__SEGMENTS_PER_THREAD),
+    .next = 0,
+  };
+  if (num_threads <= 1 || n < STRSORT__PARALLEL_MIN
+      || pthread_mutex_init(&ctx.mutex, nullptr) != 0) {
+    strsort__sort(items, n, 0, nullptr);
+    return;
+  }
+  strsort__sort(items, n, 0, &ctx);
+  threadpool *tp = threadpool_start(
+      num_threads < ctx.count ? num_threads : ctx.count, strsort__work, &ctx);
+  if (tp == nullptr) {
+    strsort__work(&ctx, 0);
+  } else {
+    threadpool_join(&tp);
+  }
+  pthread_mutex_destroy(&ctx.mutex);
+  free(ctx.segments);
+}
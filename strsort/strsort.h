@@ -0,0 +1,38 @@
+//  strsort.h : partie interface d'un module de tri de chaînes d'octets.
+//  Fonctionnement général :
+//  - les éléments à trier sont des clés, chaînes d'octets de longueur connue
+//    sans octet nul, accompagnées chacune d'une référence ;
+//  - l'ordre est celui de memcmp sur les octets communs, une clé précédant
+//    toute clé dont elle est un préfixe strict ; c'est l'ordre de strcmp sur
+//    les chaînes, et celui de strcoll sur les chaînes dont les clés sont
+//    obtenues par strxfrm ;
+//  - le tri est un tri rapide à trois voies sur les caractères (multikey
+//    quicksort) qui traite les clés par tranches de huit octets : la tranche
+//    courante de chaque clé est mémorisée dans son élément, de sorte que les
+//    comparaisons portent sur des entiers et non sur les chaînes, et qu'un
+//    préfixe commun n'est lu qu'une fois.
+
+#ifndef STRSORT__H
+#define STRSORT__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  strsort_item : élément à trier, de clé key de length octets et de
+//    référence ref. Le composant prefix est réservé au module.
+typedef struct {
+  const char *key;
+  size_t length;
+  void *ref;
+  uint64_t prefix;
+} strsort_item;
+
+//  strsort : trie dans l'ordre croissant de leurs clés les n éléments du
+//    tableau items. L'ordre relatif des éléments de clés égales n'est pas
+//    spécifié. Si num_threads est strictement supérieur à 1, le tableau est
+//    d'abord partagé en segments qui sont ensuite triés par num_threads fils
+//    d'exécution au plus ; en cas de dépassement de capacité, le tri se
+//    poursuit dans le fil appelant.
+extern void strsort(strsort_item *items, size_t n, size_t num_threads);
+
+#endif
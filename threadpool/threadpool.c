@@ -0,0 +1,84 @@
+//  threadpool.c : partie implantation du module threadpool.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "threadpool.h"
+
+//  threadpool__worker : paramètre d'un fil. fun et context sont la fonction
+//    de travail et son contexte, index le numéro du fil.
+typedef struct {
+  void (*fun)(void *context, size_t worker);
+  void *context;
+  size_t index;
+} threadpool__worker;
+
+//  struct threadpool, threadpool : les n fils lancés sont repérés par le
+//    tableau threads ; workers est le tableau de leurs paramètres.
+struct threadpool {
+  pthread_t *threads;
+  threadpool__worker *workers;
+  size_t n;
+};
+
+//  threadpool__run : fonction de départ d'un fil, de paramètre pointé par arg.
+static void *threadpool__run(void *arg) {
+  threadpool__worker *w = arg;
+  w->fun(w->context, w->index);
+  return nullptr;
+}
+
+threadpool *threadpool_start(size_t n,
+    void (*fun)(void *context, size_t worker), void *context) {
+  if (n == 0 || n > THREADPOOL_MAX_THREADS) {
+    return nullptr;
+  }
+  threadpool *tp = malloc(sizeof *tp);
+  if (tp == nullptr) {
+    return nullptr;
+  }
+  tp->threads = malloc(n * sizeof *tp->threads);
+  tp->workers = malloc(n * sizeof *tp->workers);
+  if (tp->threads == nullptr || tp->workers == nullptr) {
+    free(tp->threads);
+    free(tp->workers);
+    free(tp);
+    return nullptr;
+  }
+  tp->n = 0;
+  for (size_t k = 0; k < n; ++k) {
+    tp->workers[k] = (threadpool__worker) {
+      fun, context, k
+    };
+    if (pthread_create(&tp->threads[k], nullptr, threadpool__run,
+        &tp->workers[k]) != 0) {
+      break;
+    }
+    tp->n += 1;
+  }
+  if (tp->n == 0) {
+    free(tp->threads);
+    free(tp->workers);
+    free(tp);
+    return nullptr;
+  }
+  return tp;
+}
+
+size_t threadpool_size(const threadpool *tp) {
+  return tp->n;
+}
+
+void threadpool_join(threadpool **tpptr) {
+  if (*tpptr == nullptr) {
+    return;
+  }
+  for (size_t k = 0; k < (*tpptr)->n; ++k) {
+    pthread_join((*tpptr)->threads[k], nullptr);
+  }
+  free((*tpptr)->threads);
+  free((*tpptr)->workers);
+  free(*tpptr);
+  *tpptr = nullptr;
+}
@@ -0,0 +1,41 @@
+//  threadpool.h : partie interface d'un module de groupe de fils d'exécution
+//    exécutant une même fonction de travail.
+//  Fonctionnement général :
+//  - chaque fil du groupe exécute une fois la fonction de travail, avec le
+//    contexte commun et son propre numéro ;
+//  - la répartition du travail entre les fils (au moyen de compteurs partagés
+//    par exemple) ainsi que la synchronisation de l'accès au contexte sont à
+//    la charge de la fonction de travail, qui doit s'accommoder d'un nombre de
+//    fils inférieur au nombre demandé.
+
+#ifndef THREADPOOL__H
+#define THREADPOOL__H
+
+#include <stddef.h>
+
+//  THREADPOOL_MAX_THREADS : nombre maximal de fils d'un groupe.
+#define THREADPOOL_MAX_THREADS 1024
+
+//  struct threadpool, threadpool : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer un groupe de fils.
+typedef struct threadpool threadpool;
+
+//  threadpool_start : tente de lancer n fils d'exécution, 1 ≤ n ≤
+//    THREADPOOL_MAX_THREADS, le fil numéro k exécutant fun(context, k).
+//    Renvoie un pointeur nul si n n'est pas dans les bornes ou si aucun fil
+//    n'a pu être lancé. Renvoie sinon un pointeur vers le contrôleur associé
+//    au groupe, éventuellement formé de moins de n fils en cas de dépassement
+//    de capacité.
+extern threadpool *threadpool_start(size_t n,
+    void (*fun)(void *context, size_t worker), void *context);
+
+//  threadpool_size : renvoie le nombre de fils du groupe associé à tp.
+extern size_t threadpool_size(const threadpool *tp);
+
+//  threadpool_join : sans effet si *tpptr vaut un pointeur nul. Attend sinon
+//    la fin de l'exécution de tous les fils du groupe associé à *tpptr, libère
+//    les ressources allouées à sa gestion puis affecte un pointeur nul à
+//    *tpptr.
+extern void threadpool_join(threadpool **tpptr);
+
+#endif
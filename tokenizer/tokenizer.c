@@ -0,0 +1,328 @@
+//  tokenizer.c : partie implantation du module tokenizer.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tokenizer.h"
+
+#if defined __GNUC__ && defined __SSE2__
+#define TOKENIZER__X86
+#include <immintrin.h>
+#endif
+
+//  TOKENIZER_BLOCK_SIZE : taille des blocs de lecture des fichiers qui ne
+//    sont pas projetés en mémoire.
+#define TOKENIZER_BLOCK_SIZE ((size_t) 1 << 20)
+
+//  tokenizer__state : état du découpage. punctuation_as_space, max_length,
+//    fun et context sont les paramètres de tokenizer_scan. carry est le
+//    tampon, de capacité capacity, dans lequel sont recopiés les length
+//    premiers octets d'un mot à cheval sur deux blocs ; length est nul hors
+//    d'un tel mot. is_delimiter est la table de classe des octets, établie
+//    une fois pour toutes selon la locale au début du découpage. Pour
+//    0 <= h < 8, le bit h de bitmap_low[l] (respectivement bitmap_high[l])
+//    vaut 1 si et seulement si l'octet de quartet de poids fort h
+//    (respectivement h + 8) et de quartet de poids faible l est un séparateur.
+//    find est la fonction de recherche retenue pour le processeur.
+typedef struct tokenizer__state tokenizer__state;
+
+struct tokenizer__state {
+  bool punctuation_as_space;
+  size_t max_length;
+  tokenizer_fun fun;
+  void *context;
+  char *carry;
+  size_t length;
+  size_t capacity;
+  bool is_delimiter[256];
+  uint8_t bitmap_low[16];
+  uint8_t bitmap_high[16];
+  size_t (*find)(const tokenizer__state *st, const unsigned char *u,
+      size_t i, size_t n, bool delimiter);
+};
+
+//  tokenizer__init_classes : établit les tables de classe des octets de
+//    st selon la locale courante. Le prédicat est appliqué à (char) c, comme
+//    le faisait la lecture caractère par caractère, afin de conserver le
+//    découpage des octets de valeur supérieure à 127.
+static void tokenizer__init_classes(tokenizer__state *st) {
+  memset(st->bitmap_low, 0, sizeof st->bitmap_low);
+  memset(st->bitmap_high, 0, sizeof st->bitmap_high);
+  for (int c = 0; c < 256; ++c) {
+    char ch = (char) c;
+    bool d = isspace(ch) || (st->punctuation_as_space && ispunct(ch));
+    st->is_delimiter[c] = d;
+    if (d) {
+      uint8_t *bitmap = c < 128 ? st->bitmap_low : st->bitmap_high;
+      bitmap[c & 0x0f] = (uint8_t) (bitmap[c & 0x0f] | (1 << ((c >> 4) & 7)));
+    }
+  }
+}
+
+//  tokenizer__find_scalar : renvoie le plus petit indice j, i <= j < n, tel
+//    que u[j] soit un séparateur si delimiter vaut true, n'en soit pas un
+//    sinon. Renvoie n si un tel indice n'existe pas.
+static size_t tokenizer__find_scalar(const tokenizer__state *st,
+    const unsigned char *u, size_t i, size_t n, bool delimiter) {
+  while (i < n && st->is_delimiter[u[i]] != delimiter) {
+    ++i;
+  }
+  return i;
+}
+
+#if defined TOKENIZER__X86
+
+//  tokenizer__find_avx2 : comme tokenizer__find_scalar, mais classe les
+//    octets par blocs de 32. Le quartet de poids faible de chaque octet
+//    sélectionne, par pshufb, une ligne des deux tables bitmap_low et
+//    bitmap_high ; son quartet de poids fort choisit la table et le bit de
+//    la ligne. La fin du tableau est traitée octet par octet.
+__attribute__((target("avx2")))
+static size_t tokenizer__find_avx2(const tokenizer__state *st,
+    const unsigned char *u, size_t i, size_t n, bool delimiter) {
+  const __m256i low_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) st->bitmap_low));
+  const __m256i high_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *) st->bitmap_high));
+  const __m256i bits = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i seven = _mm256_set1_epi8(7);
+  const uint32_t flip = delimiter ? 0 : UINT32_MAX;
+  while (i + 32 <= n) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (u + i));
+    __m256i lo = _mm256_and_si256(v, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_table, lo),
+        _mm256_shuffle_epi8(high_table, lo), _mm256_cmpgt_epi8(hi, seven));
+    __m256i bit = _mm256_shuffle_epi8(bits, hi);
+    __m256i hit = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+    uint32_t m = (uint32_t) _mm256_movemask_epi8(hit) ^ flip;
+    if (m != 0) {
+      return i + (size_t) __builtin_ctz(m);
+    }
+    i += 32;
+  }
+  return tokenizer__find_scalar(st, u, i, n, delimiter);
+}
+
+//  tokenizer__find_ssse3 : comme tokenizer__find_avx2, par blocs de 16.
+__attribute__((target("ssse3")))
+static size_t tokenizer__find_ssse3(const tokenizer__state *st,
+    const unsigned char *u, size_t i, size_t n, bool delimiter) {
+  const __m128i low_table = _mm_loadu_si128((const __m128i *) st->bitmap_low);
+  const __m128i high_table
+    = _mm_loadu_si128((const __m128i *) st->bitmap_high);
+  const __m128i bits = _mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const __m128i seven = _mm_set1_epi8(7);
+  const uint32_t flip = delimiter ? 0 : 0xffff;
+  while (i + 16 <= n) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (u + i));
+    __m128i lo = _mm_and_si128(v, nibble);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    __m128i high = _mm_cmpgt_epi8(hi, seven);
+    __m128i row = _mm_or_si128(
+        _mm_andnot_si128(high, _mm_shuffle_epi8(low_table, lo)),
+        _mm_and_si128(high, _mm_shuffle_epi8(high_table, lo)));
+    __m128i bit = _mm_shuffle_epi8(bits, hi);
+    __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+    uint32_t m = (uint32_t) _mm_movemask_epi8(hit) ^ flip;
+    if (m != 0) {
+      return i + (size_t) __builtin_ctz(m);
+    }
+    i += 16;
+  }
+  return tokenizer__find_scalar(st, u, i, n, delimiter);
+}
+
+#endif
+
+//  tokenizer__select_find : renvoie la fonction de recherche la plus rapide
+//    que permet le processeur.
+static size_t (*tokenizer__select_find(void))(const tokenizer__state *,
+    const unsigned char *, size_t, size_t, bool) {
+#if defined TOKENIZER__X86
+  if (__builtin_cpu_supports("avx2")) {
+    return tokenizer__find_avx2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return tokenizer__find_ssse3;
+  }
+#endif
+  return tokenizer__find_scalar;
+}
+
+//  tokenizer__emit : transmet le mot complet de n octets, n > 0, débutant à
+//    l'adresse p, en morceaux de st->max_length octets si nécessaire. Renvoie
+//    zéro ou la valeur non nulle renvoyée par st->fun.
+static int tokenizer__emit(tokenizer__state *st, const char *p, size_t n) {
+  if (st->max_length != 0) {
+    while (n > st->max_length) {
+      int r = st->fun(st->context, p, st->max_length);
+      if (r != 0) {
+        return r;
+      }
+      p += st->max_length;
+      n -= st->max_length;
+    }
+  }
+  return st->fun(st->context, p, n);
+}
+
+//  tokenizer__append : ajoute au mot en cours de recopie les n octets débutant
+//    à l'adresse p, qui ne le terminent pas nécessairement. Lorsque
+//    st->max_length est non nul, transmet chaque morceau complet dès que le
+//    mot se poursuit au-delà. Renvoie zéro en cas de succès, -1 en cas
+//    d'erreur d'allocation, la valeur non nulle renvoyée par st->fun sinon.
+static int tokenizer__append(tokenizer__state *st, const char *p, size_t n) {
+  while (n > 0) {
+    if (st->max_length != 0 && st->length == st->max_length) {
+      int r = st->fun(st->context, st->carry, st->length);
+      if (r != 0) {
+        return r;
+      }
+      st->length = 0;
+    }
+    size_t k = n;
+    if (st->max_length != 0 && k > st->max_length - st->length) {
+      k = st->max_length - st->length;
+    }
+    if (st->length + k > st->capacity) {
+      size_t c = st->capacity == 0 ? 256 : st->capacity;
+      while (c < st->length + k) {
+        c *= 2;
+      }
+      char *q = realloc(st->carry, c);
+      if (q == nullptr) {
+        return -1;
+      }
+      st->carry = q;
+      st->capacity = c;
+    }
+    memcpy(st->carry + st->length, p, k);
+    st->length += k;
+    p += k;
+    n -= k;
+  }
+  return 0;
+}
+
+//  tokenizer__flush : transmet le mot en cours de recopie, s'il existe.
+//    Renvoie zéro ou la valeur non nulle renvoyée par st->fun.
+static int tokenizer__flush(tokenizer__state *st) {
+  if (st->length == 0) {
+    return 0;
+  }
+  size_t n = st->length;
+  st->length = 0;
+  return st->fun(st->context, st->carry, n);
+}
+
+//  tokenizer__feed : découpe le bloc de n octets débutant à l'adresse p, qui
+//    prolonge le mot en cours de recopie s'il existe. Les mots entièrement
+//    contenus dans le bloc sont transmis sur place. Si last vaut false, le
+//    mot qui termine éventuellement le bloc est recopié ; il est sinon
+//    transmis. Renvoie zéro en cas de succès, -1 en cas d'erreur
+//    d'allocation, la valeur non nulle renvoyée par st->fun sinon.
+static int tokenizer__feed(tokenizer__state *st, const char *p, size_t n,
+    bool last) {
+  const unsigned char *u = (const unsigned char *) p;
+  size_t i = 0;
+  if (st->length > 0) {
+    i = st->find(st, u, i, n, true);
+    int r = tokenizer__append(st, p, i);
+    if (r == 0 && (i < n || last)) {
+      r = tokenizer__flush(st);
+    }
+    if (r != 0) {
+      return r;
+    }
+  }
+  for (;;) {
+    i = st->find(st, u, i, n, false);
+    if (i == n) {
+      return 0;
+    }
+    size_t start = i;
+    i = st->find(st, u, i, n, true);
+    int r = (i == n && !last)
+        ? tokenizer__append(st, p + start, i - start)
+        : tokenizer__emit(st, p + start, i - start);
+    if (r != 0) {
+      return r;
+    }
+  }
+}
+
+//  tokenizer__scan_mapped : tente de projeter en mémoire le fichier régulier
+//    non vide de descripteur fd et de taille size. Renvoie false si la
+//    projection a échoué. Découpe sinon le fichier, affecte à *result la
+//    valeur renvoyée par tokenizer__feed et renvoie true.
+static bool tokenizer__scan_mapped(tokenizer__state *st, int fd, size_t size,
+    int *result) {
+  void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+  *result = tokenizer__feed(st, map, size, true);
+  munmap(map, size);
+  return true;
+}
+
+int tokenizer_scan(int fd, bool punctuation_as_space,
+    size_t max_length, tokenizer_fun fun, void *context) {
+  tokenizer__state st = {
+    .punctuation_as_space = punctuation_as_space,
+    .max_length = max_length,
+    .fun = fun,
+    .context = context,
+    .carry = nullptr,
+    .length = 0,
+    .capacity = 0,
+    .find = tokenizer__select_find(),
+  };
+  tokenizer__init_classes(&st);
+  struct stat sb;
+  if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0
+      && (uintmax_t) sb.st_size <= SIZE_MAX) {
+    int r;
+    if (tokenizer__scan_mapped(&st, fd, (size_t) sb.st_size, &r)) {
+      return r;
+    }
+  }
+  char *block = malloc(TOKENIZER_BLOCK_SIZE);
+  if (block == nullptr) {
+    return -1;
+  }
+  int r = 0;
+  for (;;) {
+    ssize_t k = read(fd, block, TOKENIZER_BLOCK_SIZE);
+    if (k < 0 && errno == EINTR) {
+      continue;
+    }
+    if (k <= 0) {
+      break;
+    }
+    r = tokenizer__feed(&st, block, (size_t) k, false);
+    if (r != 0) {
+      break;
+    }
+  }
+  if (r == 0) {
+    r = tokenizer__flush(&st);
+  }
+  free(st.carry);
+  free(block);
+  return r;
+}
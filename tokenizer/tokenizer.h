@@ -0,0 +1,40 @@
+//  tokenizer.h : partie interface d'un module de découpage en mots du contenu
+//    d'un fichier.
+//  Fonctionnement général :
+//  - un mot est une suite maximale d'octets qui ne sont pas des séparateurs.
+//    Un octet c est un séparateur si isspace((char) c) est vrai ou, lorsque la
+//    ponctuation est traitée comme un séparateur, si ispunct((char) c) est
+//    vrai, selon la locale courante ;
+//  - le contenu d'un fichier régulier est projeté en mémoire et parcouru sur
+//    place ; celui des autres fichiers (tubes, terminaux…) est lu par grands
+//    blocs. Seuls les mots à cheval sur deux blocs sont recopiés ;
+//  - les mots sont transmis à une fonction sous la forme de tranches (adresse
+//    du premier octet, longueur), sans caractère nul final. Les tranches ne
+//    sont valides que le temps de l'appel ;
+//  - une erreur de lecture est traitée comme une fin de fichier.
+
+#ifndef TOKENIZER__H
+#define TOKENIZER__H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+//  tokenizer_fun : type des fonctions auxquelles tokenizer_scan transmet les
+//    mots. Une telle fonction reçoit son contexte context et la tranche de
+//    length octets, length > 0, débutant à l'adresse word. Elle renvoie zéro
+//    pour poursuivre le découpage, une valeur strictement positive pour
+//    l'interrompre.
+typedef int (*tokenizer_fun)(void *context, const char *word, size_t length);
+
+//  tokenizer_scan : découpe en mots le contenu du fichier ouvert en lecture
+//    de descripteur fd, la ponctuation étant traitée comme un séparateur si
+//    punctuation_as_space vaut true, et transmet chacun des mots, dans l'ordre,
+//    à fun avec le contexte context. Si max_length est non nul, un mot de plus
+//    de max_length octets est transmis en morceaux consécutifs de max_length
+//    octets, le dernier morceau étant éventuellement plus court. Renvoie zéro
+//    en cas de succès, -1 en cas d'erreur d'allocation, la valeur renvoyée par
+//    fun si elle a interrompu le découpage.
+extern int tokenizer_scan(int fd, bool punctuation_as_space,
+    size_t max_length, tokenizer_fun fun, void *context);
+
+#endif
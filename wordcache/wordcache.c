@@ -0,0 +1,306 @@
+//  wordcache.c : partie implantation du module wordcache.
+
+#define _XOPEN_SOURCE 700
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "wordcache.h"
+
+//  WORDCACHE__MAGIC, WORDCACHE__MAGIC_LENGTH : signature, version du format
+//    comprise, des fichiers d'entrée et sa longueur.
+#define WORDCACHE__MAGIC "JDISWC\0\2"
+#define WORDCACHE__MAGIC_LENGTH 8
+
+//  WORDCACHE__BYTE_ORDER : valeur témoin de l'ordre des octets de la machine
+//    qui a écrit une entrée.
+#define WORDCACHE__BYTE_ORDER UINT32_C(0x01020304)
+
+//  WORDCACHE__SUFFIX : suffixe des noms des fichiers d'entrée.
+#define WORDCACHE__SUFFIX ".jwc"
+
+//  wordcache__header : en-tête d'un fichier d'entrée. Il est suivi du chemin
+//    absolu du fichier source (path_length octets), du texte des messages
+//    (diag_length octets) puis des word_count mots, chacun terminé par un
+//    caractère nul (strings_length octets en tout).
+typedef struct {
+  char magic[WORDCACHE__MAGIC_LENGTH];
+  uint32_t byte_order;
+  uint32_t punct;
+  int32_t limit;
+  uint32_t reserved;
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t path_length;
+  uint64_t diag_length;
+  uint64_t strings_length;
+  uint64_t word_count;
+} wordcache__header;
+
+//  struct wordcache, wordcache : dir est le chemin du répertoire du cache.
+struct wordcache {
+  char *dir;
+};
+
+//  struct wordcache_entry, wordcache_entry : le fichier d'entrée est projeté
+//    sur les map_length octets débutant à l'adresse map ; words repère ses
+//    count mots, diag le texte des messages, de longueur diag_length.
+struct wordcache_entry {
+  void *map;
+  size_t map_length;
+  const char *words;
+  size_t count;
+  const char *diag;
+  size_t diag_length;
+};
+
+//  wordcache__hash : renvoie la valeur de hachage FNV-1a sur 64 bits, de
+//    valeur initiale h, des n octets de la zone pointée par p.
+static uint64_t wordcache__hash(uint64_t h, const void *p, size_t n) {
+  const unsigned char *s = p;
+  for (size_t k = 0; k < n; ++k) {
+    h ^= s[k];
+    h *= UINT64_C(0x100000001B3);
+  }
+  return h;
+}
+
+//  wordcache__entry_path : tente d'affecter à *realptr le chemin absolu du
+//    fichier filename et de renvoyer le chemin du fichier d'entrée du cache
+//    associé à wc pour ce fichier et les options limit et punct, chaînes
+//    allouées dynamiquement. Renvoie un pointeur nul en cas d'échec, auquel
+//    cas *realptr est un pointeur nul.
+static char *wordcache__entry_path(const wordcache *wc, const char *filename,
+    int limit, bool punct, char **realptr) {
+  *realptr = realpath(filename, nullptr);
+  if (*realptr == nullptr) {
+    return nullptr;
+  }
+  uint64_t h = UINT64_C(0xCBF29CE484222325);
+  h = wordcache__hash(h, *realptr, strlen(*realptr) + 1);
+  int32_t l = limit;
+  unsigned char p = punct;
+  h = wordcache__hash(h, &l, sizeof l);
+  h = wordcache__hash(h, &p, sizeof p);
+  size_t n = strlen(wc->dir) + 1 + 16 + strlen(WORDCACHE__SUFFIX) + 1;
+  char *path = malloc(n);
+  if (path == nullptr) {
+    free(*realptr);
+    *realptr = nullptr;
+    return nullptr;
+  }
+  snprintf(path, n, "%s/%016llx" WORDCACHE__SUFFIX, wc->dir,
+      (unsigned long long) h);
+  return path;
+}
+
+//  wordcache__fill_identity : affecte aux composants d'identité et d'options
+//    de l'en-tête pointé par h les valeurs tirées de *st, limit et punct.
+static void wordcache__fill_identity(wordcache__header *h,
+    const struct stat *st, int limit, bool punct) {
+  memset(h, 0, sizeof *h);
+  memcpy(h->magic, WORDCACHE__MAGIC, WORDCACHE__MAGIC_LENGTH);
+  h->byte_order = WORDCACHE__BYTE_ORDER;
+  h->punct = punct;
+  h->limit = limit;
+  h->dev = (uint64_t) st->st_dev;
+  h->ino = (uint64_t) st->st_ino;
+  h->size = (uint64_t) st->st_size;
+  h->mtime_sec = (int64_t) st->st_mtim.tv_sec;
+  h->mtime_nsec = (int64_t) st->st_mtim.tv_nsec;
+}
+
+wordcache *wordcache_open(const char *dir) {
+  if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+    return nullptr;
+  }
+  struct stat st;
+  if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+    return nullptr;
+  }
+  wordcache *wc = malloc(sizeof *wc);
+  if (wc == nullptr) {
+    return nullptr;
+  }
+  wc->dir = strdup(dir);
+  if (wc->dir == nullptr) {
+    free(wc);
+    return nullptr;
+  }
+  return wc;
+}
+
+void wordcache_close(wordcache **wcptr) {
+  if (*wcptr == nullptr) {
+    return;
+  }
+  free((*wcptr)->dir);
+  free(*wcptr);
+  *wcptr = nullptr;
+}
+
+wordcache_entry *wordcache_load(const wordcache *wc, const char *filename,
+    const struct stat *st, int limit, bool punct) {
+  char *real;
+  char *path = wordcache__entry_path(wc, filename, limit, punct, &real);
+  wordcache_entry *e = nullptr;
+  int fd = -1;
+  void *map = MAP_FAILED;
+  size_t length = 0;
+  if (path == nullptr) {
+    goto cleanup;
+  }
+  fd = open(path, O_RDONLY);
+  struct stat est;
+  if (fd == -1 || fstat(fd, &est) != 0
+      || est.st_size < (off_t) sizeof(wordcache__header)) {
+    goto cleanup;
+  }
+  length = (size_t) est.st_size;
+  map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    goto cleanup;
+  }
+  wordcache__header expected;
+  wordcache__header h;
+  wordcache__fill_identity(&expected, st, limit, punct);
+  memcpy(&h, map, sizeof h);
+  //  L'identité et les options sont comparées, puis les longueurs, avant toute
+  //    lecture au-delà de l'en-tête.
+  size_t avail = length - sizeof h;
+  size_t real_length = strlen(real);
+  if (memcmp(&h, &expected, offsetof(wordcache__header, path_length)) != 0
+      || h.path_length != real_length
+      || h.path_length > avail
+      || h.diag_length > avail - h.path_length
+      || h.strings_length != avail - h.path_length - h.diag_length
+      || h.word_count > h.strings_length) {
+    goto cleanup;
+  }
+  const char *base = (const char *) map + sizeof h;
+  if (memcmp(base, real, real_length) != 0) {
+    goto cleanup;
+  }
+  const char *words = base + h.path_length + h.diag_length;
+  size_t n = (size_t) h.strings_length;
+  if (n > 0 && words[n - 1] != '\0') {
+    goto cleanup;
+  }
+  size_t count = 0;
+  for (const char *p = words; p < words + n; ++count) {
+    p = (const char *) memchr(p, '\0', (size_t) (words + n - p)) + 1;
+  }
+  if (count != h.word_count) {
+    goto cleanup;
+  }
+  e = malloc(sizeof *e);
+  if (e == nullptr) {
+    goto cleanup;
+  }
+  *e = (wordcache_entry) {
+    .map = map,
+    .map_length = length,
+    .words = words,
+    .count = count,
+    .diag = base + h.path_length,
+    .diag_length = (size_t) h.diag_length,
+  };
+  map = MAP_FAILED;
+cleanup:
+  if (map != MAP_FAILED) {
+    munmap(map, length);
+  }
+  if (fd != -1) {
+    close(fd);
+  }
+  free(path);
+  free(real);
+  return e;
+}
+
+int wordcache_store(const wordcache *wc, const char *filename,
+    const struct stat *st, int limit, bool punct, const char * const *words,
+    size_t count, const char *diag, size_t diag_length) {
+  char *real;
+  char *path = wordcache__entry_path(wc, filename, limit, punct, &real);
+  char *temp = nullptr;
+  int r = -1;
+  if (path == nullptr) {
+    goto cleanup;
+  }
+  size_t n = strlen(path) + strlen(".XXXXXX") + 1;
+  temp = malloc(n);
+  if (temp == nullptr) {
+    goto cleanup;
+  }
+  snprintf(temp, n, "%s.XXXXXX", path);
+  int fd = mkstemp(temp);
+  if (fd == -1) {
+    goto cleanup;
+  }
+  FILE *f = fdopen(fd, "wb");
+  if (f == nullptr) {
+    close(fd);
+    unlink(temp);
+    goto cleanup;
+  }
+  wordcache__header h;
+  wordcache__fill_identity(&h, st, limit, punct);
+  h.path_length = strlen(real);
+  h.diag_length = diag_length;
+  h.word_count = count;
+  for (size_t k = 0; k < count; ++k) {
+    h.strings_length += strlen(words[k]) + 1;
+  }
+  fwrite(&h, sizeof h, 1, f);
+  fwrite(real, 1, (size_t) h.path_length, f);
+  fwrite(diag, 1, diag_length, f);
+  for (size_t k = 0; k < count; ++k) {
+    fwrite(words[k], 1, strlen(words[k]) + 1, f);
+  }
+  if (ferror(f) != 0) {
+    fclose(f);
+    unlink(temp);
+    goto cleanup;
+  }
+  if (fclose(f) != 0 || rename(temp, path) != 0) {
+    unlink(temp);
+    goto cleanup;
+  }
+  r = 0;
+cleanup:
+  free(temp);
+  free(path);
+  free(real);
+  return r;
+}
+
+void wordcache_entry_dispose(wordcache_entry **eptr) {
+  if (*eptr == nullptr) {
+    return;
+  }
+  munmap((*eptr)->map, (*eptr)->map_length);
+  free(*eptr);
+  *eptr = nullptr;
+}
+
+size_t wordcache_entry_count(const wordcache_entry *e) {
+  return e->count;
+}
+
+const char *wordcache_entry_words(const wordcache_entry *e) {
+  return e->words;
+}
+
+const char *wordcache_entry_diag(const wordcache_entry *e, size_t *length) {
+  *length = e->diag_length;
+  return e->diag;
+}
@@ -0,0 +1,89 @@
+//  wordcache.h : partie interface d'un module de cache sur disque des mots
+//    distincts de fichiers.
+//  Fonctionnement général :
+//  - le cache est un répertoire ; chaque entrée est un fichier qui mémorise,
+//    pour un fichier source et des options de lecture données (limite de
+//    longueur des mots et traitement de la ponctuation), la suite des mots
+//    distincts du fichier dans l'ordre de leur première occurrence ainsi que
+//    les données permettant de reproduire les messages émis lors de sa
+//    lecture, sous le nom qu'aura alors le fichier ;
+//  - une entrée est désignée par le chemin absolu du fichier source et les
+//    options de lecture ; elle mémorise en outre l'identité du fichier source
+//    lors de sa lecture (périphérique, numéro d'inœud, taille et date de
+//    dernière modification), qui doit être celle du fichier courant pour que
+//    l'entrée soit valide. Une entrée périmée est remplacée à l'écriture
+//    suivante ;
+//  - une entrée valide est projetée en mémoire, ses mots étant lus sur place ;
+//  - les entrées sont écrites dans un fichier temporaire qui est ensuite
+//    renommé, de sorte que des exécutions concurrentes partageant le même
+//    cache ne lisent jamais une entrée incomplète ;
+//  - les fonctions du module peuvent être appelées simultanément par
+//    plusieurs fils d'exécution.
+
+#ifndef WORDCACHE__H
+#define WORDCACHE__H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+//  struct wordcache, wordcache : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer un cache.
+typedef struct wordcache wordcache;
+
+//  struct wordcache_entry, wordcache_entry : type et nom de type d'un
+//    contrôleur regroupant les informations nécessaires pour gérer une entrée
+//    valide projetée en mémoire.
+typedef struct wordcache_entry wordcache_entry;
+
+//  wordcache_open : tente d'ouvrir le cache de répertoire dir, en créant ce
+//    répertoire s'il n'existe pas. Renvoie un pointeur nul si dir ne désigne
+//    pas un répertoire et ne peut être créé ou en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé au cache.
+extern wordcache *wordcache_open(const char *dir);
+
+//  wordcache_close : sans effet si *wcptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion du cache associé à *wcptr puis
+//    affecte un pointeur nul à *wcptr.
+extern void wordcache_close(wordcache **wcptr);
+
+//  wordcache_load : recherche dans le cache associé à wc l'entrée du fichier
+//    filename, d'identité courante *st, pour la limite de longueur limit et
+//    le traitement de la ponctuation punct. Renvoie un pointeur nul si
+//    l'entrée est absente, périmée ou invalide ou en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'entrée projetée en mémoire.
+extern wordcache_entry *wordcache_load(const wordcache *wc,
+    const char *filename, const struct stat *st, int limit, bool punct);
+
+//  wordcache_store : tente d'écrire dans le cache associé à wc l'entrée du
+//    fichier filename, d'identité *st avant sa lecture, pour la limite de
+//    longueur limit et le traitement de la ponctuation punct. Ses mots sont
+//    les count chaînes du tableau words, les données des messages émis lors
+//    de sa lecture, dont l'utilisateur choisit le format, les diag_length
+//    octets de la zone pointée par diag. Une entrée existante
+//    est remplacée. Renvoie 0 en cas de succès, -1 en cas d'échec.
+extern int wordcache_store(const wordcache *wc, const char *filename,
+    const struct stat *st, int limit, bool punct, const char * const *words,
+    size_t count, const char *diag, size_t diag_length);
+
+//  wordcache_entry_dispose : sans effet si *eptr vaut un pointeur nul. Libère
+//    sinon les ressources allouées à la gestion de l'entrée associée à *eptr,
+//    ce qui invalide les chaînes qu'elle a fournies, puis affecte un pointeur
+//    nul à *eptr.
+extern void wordcache_entry_dispose(wordcache_entry **eptr);
+
+//  wordcache_entry_count : renvoie le nombre de mots de l'entrée associée à
+//    e.
+extern size_t wordcache_entry_count(const wordcache_entry *e);
+
+//  wordcache_entry_words : renvoie l'adresse du premier mot de l'entrée
+//    associée à e. Les mots se suivent, chacun terminé par un caractère nul.
+extern const char *wordcache_entry_words(const wordcache_entry *e);
+
+//  wordcache_entry_diag : affecte à *length la longueur des données des
+//    messages mémorisées par l'entrée associée à e et renvoie leur adresse.
+extern const char *wordcache_entry_diag(const wordcache_entry *e,
+    size_t *length);
+
+#endif
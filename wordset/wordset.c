@@ -0,0 +1,313 @@
+//  wordset.c : partie implantation du module wordset.
+
+#include <stdlib.h>
+#include <string.h>
+#include "wordset.h"
+
+#if defined __GNUC__ && defined __SSE2__
+#define WORDSET__X86
+#include <immintrin.h>
+#include <stdatomic.h>
+#endif
+
+//  struct wordset, wordset : les identifiants sont mémorisés dans le tableau
+//    dynamique ids de capacité capacity ; count est le nombre d'identifiants.
+struct wordset {
+  uint32_t *ids;
+  size_t capacity;
+  size_t count;
+};
+
+#define WORDSET__INITIAL_CAPACITY 64
+
+//  WORDSET__INSERTION_SORT_MAX : nombre d'identifiants en deçà duquel le tri
+//    par insertion est préféré au tri par base.
+#define WORDSET__INSERTION_SORT_MAX 64
+
+//  WORDSET__GALLOP_RATIO : rapport des cardinaux à partir duquel l'
+//    intersection procède par recherche exponentielle des éléments du plus
+//    petit ensemble dans le plus grand plutôt que par fusion.
+#define WORDSET__GALLOP_RATIO 32
+
+wordset *wordset_empty(void) {
+  wordset *ws = malloc(sizeof *ws);
+  if (ws == nullptr) {
+    return nullptr;
+  }
+  ws->ids = nullptr;
+  ws->capacity = 0;
+  ws->count = 0;
+  return ws;
+}
+
+void wordset_dispose(wordset **wsptr) {
+  if (*wsptr == nullptr) {
+    return;
+  }
+  free((*wsptr)->ids);
+  free(*wsptr);
+  *wsptr = nullptr;
+}
+
+int wordset_put(wordset *ws, uint32_t id) {
+  if (ws->count == ws->capacity) {
+    size_t c = ws->capacity == 0 ? WORDSET__INITIAL_CAPACITY
+        : 2 * ws->capacity;
+    if (c > SIZE_MAX / sizeof *ws->ids) {
+      return -1;
+    }
+    uint32_t *a = realloc(ws->ids, c * sizeof *ws->ids);
+    if (a == nullptr) {
+      return -1;
+    }
+    ws->ids = a;
+    ws->capacity = c;
+  }
+  ws->ids[ws->count] = id;
+  ws->count += 1;
+  return 0;
+}
+
+size_t wordset_count(const wordset *ws) {
+  return ws->count;
+}
+
+const uint32_t *wordset_ids(const wordset *ws) {
+  return ws->ids;
+}
+
+//  wordset__compar : fonction de comparaison de deux identifiants pointés par
+//    a et b, pour qsort.
+static int wordset__compar(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *) a;
+  uint32_t y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
+}
+
+//  wordset__radix_sort : trie par ordre croissant les n identifiants du
+//    tableau a par un tri par base de poids faible à quatre passes d'un octet,
+//    en utilisant le tableau auxiliaire tmp de même longueur. Les passes pour
+//    lesquelles tous les identifiants ont le même octet sont omises.
+static void wordset__radix_sort(uint32_t *a, uint32_t *tmp, size_t n) {
+  size_t counts[4][256] = { { 0 } };
+  for (size_t k = 0; k < n; ++k) {
+    for (int p = 0; p < 4; ++p) {
+      counts[p][(a[k] >> (8 * p)) & 0xFF] += 1;
+    }
+  }
+  uint32_t *src = a;
+  uint32_t *dst = tmp;
+  for (int p = 0; p < 4; ++p) {
+    if (counts[p][(src[0] >> (8 * p)) & 0xFF] == n) {
+      continue;
+    }
+    size_t offset = 0;
+    for (int b = 0; b < 256; ++b) {
+      size_t c = counts[p][b];
+      counts[p][b] = offset;
+      offset += c;
+    }
+    for (size_t k = 0; k < n; ++k) {
+      dst[counts[p][(src[k] >> (8 * p)) & 0xFF]++] = src[k];
+    }
+    uint32_t *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != a) {
+    memcpy(a, src, n * sizeof *a);
+  }
+}
+
+void wordset_sort(wordset *ws) {
+  uint32_t *a = ws->ids;
+  size_t n = ws->count;
+  size_t k = 1;
+  while (k < n && a[k - 1] <= a[k]) {
+    ++k;
+  }
+  if (k >= n) {
+    return;
+  }
+  if (n <= WORDSET__INSERTION_SORT_MAX) {
+    for (; k < n; ++k) {
+      uint32_t x = a[k];
+      size_t j = k;
+      while (j > 0 && a[j - 1] > x) {
+        a[j] = a[j - 1];
+        --j;
+      }
+      a[j] = x;
+    }
+    return;
+  }
+  uint32_t *tmp = malloc(n * sizeof *tmp);
+  if (tmp == nullptr) {
+    qsort(a, n, sizeof *a, wordset__compar);
+    return;
+  }
+  wordset__radix_sort(a, tmp, n);
+  free(tmp);
+}
+
+//  wordset__merge_count : renvoie le nombre d'éléments communs aux tableaux
+//    strictement croissants a et b de longueurs respectives na et nb, par
+//    fusion sans branchement.
+static size_t wordset__merge_count(const uint32_t *a, size_t na,
+    const uint32_t *b, size_t nb) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t c = 0;
+  while (i < na && j < nb) {
+    uint32_t x = a[i];
+    uint32_t y = b[j];
+    c += (x == y);
+    i += (x <= y);
+    j += (y <= x);
+  }
+  return c;
+}
+
+//  wordset__gallop_count : renvoie le nombre d'éléments communs aux tableaux
+//    strictement croissants a et b de longueurs respectives na et nb, en
+//    recherchant chaque élément de a dans b par recherche exponentielle puis
+//    dichotomique à partir de la position atteinte précédemment. Efficace
+//    lorsque na est très petit devant nb.
+static size_t wordset__gallop_count(const uint32_t *a, size_t na,
+    const uint32_t *b, size_t nb) {
+  size_t c = 0;
+  size_t lo = 0;
+  for (size_t i = 0; i < na && lo < nb; ++i) {
+    uint32_t x = a[i];
+    size_t step = 1;
+    size_t hi = lo;
+    while (hi < nb && b[hi] < x) {
+      lo = hi + 1;
+      hi += step;
+      step *= 2;
+    }
+    if (hi > nb) {
+      hi = nb;
+    }
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (b[mid] < x) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo < nb && b[lo] == x) {
+      ++c;
+      ++lo;
+    }
+  }
+  return c;
+}
+
+#if defined WORDSET__X86
+
+//  wordset__sse2_count : comme wordset__merge_count, mais compare les blocs de
+//    quatre éléments de a à ceux de b et à leurs trois rotations. Les éléments
+//    étant uniques dans chaque tableau, une égalité n'est comptée qu'une fois.
+//    La fin des tableaux est traitée par fusion scalaire.
+static size_t wordset__sse2_count(const uint32_t *a, size_t na,
+    const uint32_t *b, size_t nb) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t c = 0;
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *) (b + j));
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+        _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+        _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)),
+        _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+    c += (size_t) __builtin_popcount(
+        (unsigned) _mm_movemask_ps(_mm_castsi128_ps(m)));
+    uint32_t amax = a[i + 3];
+    uint32_t bmax = b[j + 3];
+    i += (amax <= bmax) ? 4 : 0;
+    j += (bmax <= amax) ? 4 : 0;
+  }
+  return c + wordset__merge_count(a + i, na - i, b + j, nb - j);
+}
+
+//  wordset__avx2_count : comme wordset__sse2_count, avec des blocs de huit
+//    éléments et leurs sept rotations.
+__attribute__((target("avx2")))
+static size_t wordset__avx2_count(const uint32_t *a, size_t na,
+    const uint32_t *b, size_t nb) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t c = 0;
+  const __m256i rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i *) (b + j));
+    __m256i m = _mm256_cmpeq_epi32(va, vb);
+    for (int r = 1; r < 8; ++r) {
+      vb = _mm256_permutevar8x32_epi32(vb, rot);
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi32(va, vb));
+    }
+    c += (size_t) __builtin_popcount(
+        (unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(m)));
+    uint32_t amax = a[i + 7];
+    uint32_t bmax = b[j + 7];
+    i += (amax <= bmax) ? 8 : 0;
+    j += (bmax <= amax) ? 8 : 0;
+  }
+  return c + wordset__sse2_count(a + i, na - i, b + j, nb - j);
+}
+
+//  wordset__kernel_fun : type des noyaux de comptage par blocs.
+typedef size_t (*wordset__kernel_fun)(const uint32_t *, size_t,
+    const uint32_t *, size_t);
+
+//  wordset__kernel : noyau de comptage par blocs retenu pour le processeur
+//    courant, ou nullptr tant qu'il n'a pas été choisi. Le choix, fait au
+//    premier comptage, donne toujours le même résultat : des fils qui le
+//    feraient simultanément écriraient la même valeur.
+static _Atomic(wordset__kernel_fun) wordset__kernel = nullptr;
+
+//  wordset__select_kernel : renvoie le noyau de comptage par blocs le plus
+//    rapide que permet le processeur, choisi au premier appel.
+static wordset__kernel_fun wordset__select_kernel(void) {
+  wordset__kernel_fun k = atomic_load_explicit(&wordset__kernel,
+      memory_order_relaxed);
+  if (k == nullptr) {
+    k = __builtin_cpu_supports("avx2") ? wordset__avx2_count
+        : wordset__sse2_count;
+    atomic_store_explicit(&wordset__kernel, k, memory_order_relaxed);
+  }
+  return k;
+}
+
+#endif
+
+size_t wordset_intersection_count(const wordset *ws1, const wordset *ws2) {
+  const uint32_t *a = ws1->ids;
+  const uint32_t *b = ws2->ids;
+  size_t na = ws1->count;
+  size_t nb = ws2->count;
+  if (na > nb) {
+    const uint32_t *t = a;
+    a = b;
+    b = t;
+    size_t n = na;
+    na = nb;
+    nb = n;
+  }
+  if (na == 0 || a[na - 1] < b[0] || b[nb - 1] < a[0]) {
+    return 0;
+  }
+  if (na <= nb / WORDSET__GALLOP_RATIO) {
+    return wordset__gallop_count(a, na, b, nb);
+  }
+#if defined WORDSET__X86
+  return wordset__select_kernel()(a, na, b, nb);
+#else
+  return wordset__merge_count(a, na, b, nb);
+#endif
+}
@@ -0,0 +1,64 @@
+//  wordset.h : partie interface d'un module pour la représentation de
+//    l'ensemble des mots d'un fichier sous la forme d'une collection
+//    d'identifiants attribués par un dictionnaire d'internement (voir
+//    lexicon.h).
+//  Fonctionnement général :
+//  - un ensemble de mots ne stocke aucune chaîne, uniquement les identifiants
+//    entiers des mots ;
+//  - l'unicité des identifiants insérés n'est pas vérifiée par le module :
+//    elle est à la charge de l'utilisateurice ;
+//  - une fois l'ensemble complet, il est trié par wordset_sort : les
+//    intersections se calculent alors par fusion des tableaux triés, sans
+//    allocation.
+
+#ifndef WORDSET__H
+#define WORDSET__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//  struct wordset, wordset : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour gérer un ensemble d'identifiants de
+//    mots.
+typedef struct wordset wordset;
+
+//  wordset_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouvel ensemble initialement vide. Renvoie un pointeur nul en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé à l'ensemble.
+extern wordset *wordset_empty(void);
+
+//  wordset_dispose : sans effet si *wsptr vaut un pointeur nul. Libère sinon
+//    les ressources allouées à la gestion de l'ensemble associé à *wsptr puis
+//    affecte un pointeur nul à *wsptr.
+extern void wordset_dispose(wordset **wsptr);
+
+//  wordset_put : tente d'ajouter l'identifiant id à l'ensemble associé à ws.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité. Renvoie
+//    sinon zéro.
+extern int wordset_put(wordset *ws, uint32_t id);
+
+//  wordset_count : renvoie le nombre d'identifiants de l'ensemble associé à
+//    ws.
+extern size_t wordset_count(const wordset *ws);
+
+//  wordset_ids : renvoie l'adresse du tableau des wordset_count(ws)
+//    identifiants de l'ensemble associé à ws, dans leur ordre d'insertion.
+//    L'adresse n'est plus valide après un appel à wordset_put.
+extern const uint32_t *wordset_ids(const wordset *ws);
+
+//  wordset_sort : trie par ordre croissant les identifiants de l'ensemble
+//    associé à ws. Les identifiants sont ensuite rendus par wordset_ids dans
+//    cet ordre, jusqu'au prochain appel à wordset_put.
+extern void wordset_sort(wordset *ws);
+
+//  wordset_intersection_count : renvoie le nombre d'identifiants communs aux
+//    ensembles associés à ws1 et ws2, qui doivent avoir été triés par
+//    wordset_sort. La fonction n'effectue aucune allocation. Selon le rapport
+//    des cardinaux, elle procède par recherche exponentielle des éléments du
+//    plus petit ensemble dans le plus grand ou par fusion, vectorisée (SSE2 ou
+//    AVX2, choisie à l'exécution) lorsque le processeur le permet.
+extern size_t wordset_intersection_count(const wordset *ws1,
+    const wordset *ws2);
+
+#endif